@@ -13,10 +13,20 @@
 #define __BGECONFIG_HPP_ 1
 
 #include <BgeFile.hpp>
+#include <unordered_map>
+#include <functional>
 #include <algorithm>
 #include <stdint.h>
+#include <charconv>
+#include <cmath>
+#include <atomic>
+#include <memory>
+#include <future>
+#include <thread>
 #include <string.h>
+#include <string_view>
 #include <string>
+#include <utility>
 #include <vector>
 
 #ifndef _WIN32
@@ -41,6 +51,75 @@ enum class BgePropertyValueType : uint8_t
 // forward declaration needed for later
 struct BgeConfigSection;
 
+/**
+ * Buffered text writer used to save configurations
+ * 
+ * @note Everything is formatted straight into one big buffer which is written to the file
+ *       in large blocks. Without a file the text simply stays in memory.
+*/
+struct BgeConfigEmitter
+{
+    /**
+     * @brief Construct a new `BgeConfigEmitter` object
+     * 
+     * @param file The file to which we write, `nullptr` to keep everything in memory
+     * @param capacity Size of the buffer in bytes before it gets flushed to the file
+     */
+    BgeConfigEmitter(BgeFile* file = nullptr, size_t capacity = 64 * 1024);
+
+    BgeConfigEmitter(const BgeConfigEmitter&) = delete;
+    BgeConfigEmitter& operator=(const BgeConfigEmitter&) = delete;
+
+    /**
+     * @brief Flushes the remaining text and destroys this `BgeConfigEmitter` object
+     */
+    ~BgeConfigEmitter();
+
+    /**
+     * @brief Append text
+     */
+    void Append(std::string_view text);
+
+    /**
+     * @brief Append a single character
+     */
+    void Append(char chr);
+
+    /**
+     * @brief Append an integer in decimal notation
+     */
+    void AppendInt(int value);
+
+    /**
+     * @brief Append a floating-point number
+     * @note Uses the shortest notation that reads back as the exact same float, always with a decimal point
+     */
+    void AppendFloat(float value);
+
+    /**
+     * @brief Write all buffered text to the file
+     * @note Does nothing if there is no file
+     */
+    void Flush();
+
+    /**
+     * @returns The text that is currently buffered
+     */
+    std::string_view View();
+
+private:
+    /**
+     * @brief Make room for at least `size` more bytes
+     * @returns Where the next bytes should be written to
+     */
+    char* Reserve(size_t size);
+
+private:
+    std::vector<char> mBuffer;
+    size_t mLength;
+    BgeFile* mFile;
+};
+
 /**
  * Property of a configuration file
 */
@@ -94,6 +173,20 @@ public:
      */
     void Save(BgeFile& file);
 
+    /**
+     * @brief Save this property through an emitter
+     * 
+     * @param emitter The emitter to which we write
+     */
+    void Save(BgeConfigEmitter& emitter);
+
+    /**
+     * @brief Save only the value of this property through an emitter
+     * 
+     * @param emitter The emitter to which we write
+     */
+    void SaveValue(BgeConfigEmitter& emitter);
+
     /**
      * @brief Compare if two `BgeConfigProperty` objects are equal
      */
@@ -104,19 +197,101 @@ public:
      */
     bool operator!=(BgeConfigProperty& other);
 
+    /**
+     * @brief Compare if two `BgeConfigProperty` objects have the same type and value
+     * @note Only the value matching the type is compared, the name is ignored
+     */
+    bool ValueEquals(BgeConfigProperty& other);
+
+    /**
+     * @brief Get a 64-bit hash of the name, type and value of this property
+     */
+    uint64_t Hash();
+
+    /**
+     * @brief Get a 64-bit hash of the type and value of this property
+     */
+    uint64_t ValueHash();
+
+    /**
+     * @brief Change the type and value of this property
+     * @note Unlike assigning the value fields directly, this keeps the hashes of the parent sections up to date
+     */
+    void SetValue(int value);
+    void SetValue(float value);
+    void SetValue(bool value);
+    void SetValue(std::string value);
+    void SetValue(const char* value);
+
     /**
      * @brief Set the parent section
      */
     void SetParent(BgeConfigSection* parent);
 
+    /**
+     * @brief Get the parent section, `nullptr` for global properties
+     */
+    BgeConfigSection* GetParent();
+
 private:
+    friend struct BgeConfig;
+
     BgeConfigSection* mParent;
+
+    // Where this property was read from in the source text of its configuration,
+    // `mSourceBegin` points to the name, everything else is relative to it
+    size_t mSourceBegin;
+    uint32_t mSourceValueBegin;
+    uint32_t mSourceValueEnd;
+    uint32_t mSourceLineEnd;
+
+    // `ValueHash` at the time the property was read, to find out if it was edited since
+    uint64_t mSourceHash;
+
+    // Source text the span belongs to, `0` if the property wasn't read from a file
+    uint64_t mSourceId;
 };
 
 struct BgeConfigSection;
 using BgeConfigPropertyList = std::vector<BgeConfigProperty>;
 using BgeConfigSectionList = std::vector<BgeConfigSection>;
 
+/**
+ * Function that gets called after a reload changed a property
+ * @param fullName Full name/path of the changed property
+ * @param property The new property, `nullptr` if it was removed
+*/
+using BgeConfigChangeCallback = std::function<void(std::string fullName, BgeConfigProperty* property)>;
+
+/**
+ * A property that differs between two configurations
+*/
+struct BgeConfigDifference
+{
+    // Full name/path of the property
+    std::string FullName;
+
+    // The property in the first configuration, `nullptr` if it was added
+    BgeConfigProperty* Previous;
+
+    // The property in the second configuration, `nullptr` if it was removed
+    BgeConfigProperty* Current;
+};
+
+using BgeConfigDifferenceList = std::vector<BgeConfigDifference>;
+
+/**
+ * A configuration file that `BgeConfig::OpenMany` merges into one configuration
+*/
+struct BgeConfigMergeEntry
+{
+    // File path of the configuration file
+    std::string Path;
+
+    // Section that receives everything of the file, e.g. "Modules.Network", empty for the global space
+    std::string Prefix;
+};
+
 struct BgeConfigSection
 {
     // Name of the section
@@ -135,6 +310,19 @@ public:
      */
     BgeConfigSection(std::string name);
 
+    /**
+     * @brief Copy a `BgeConfigSection` object, the copied children point to the new section
+     */
+    BgeConfigSection(const BgeConfigSection& other);
+
+    /**
+     * @brief Move a `BgeConfigSection` object, the moved children point to the new section
+     */
+    BgeConfigSection(BgeConfigSection&& other) noexcept;
+
+    BgeConfigSection& operator=(const BgeConfigSection& other);
+    BgeConfigSection& operator=(BgeConfigSection&& other) noexcept;
+
     /**
      * @brief Get the full name/path to this section
      */
@@ -148,12 +336,21 @@ public:
      */
     void Save(BgeFile& file, std::string sectionPrefix = "");
 
+    /**
+     * @brief Save this section through an emitter
+     * 
+     * @param emitter The emitter to which we write
+     * @param sectionPrefix The prefix that should be added to the full section name, restored before returning
+     */
+    void Save(BgeConfigEmitter& emitter, std::string& sectionPrefix);
+
     /**
      * Get a specific property of this configuration file
      * @param name name of the desired property, not including the name of this section
      * @returns desired property, NULL if not found
     */
     BgeConfigProperty* Get(std::string name);
+    const BgeConfigProperty* Get(std::string name) const;
 
     /**
      * Get a specific section of this configuration file
@@ -161,6 +358,7 @@ public:
      * @returns desired section, NULL if not found
     */
     BgeConfigSection* GetSubSection(std::string name);
+    const BgeConfigSection* GetSubSection(std::string name) const;
 
     /**
      * @brief Check if a property exists in this configuration file
@@ -168,7 +366,7 @@ public:
      * @param name Name of the property, not including the name of this section
      * @returns `true` if the property exists, otherwise `false`
      */
-    bool HasProperty(std::string name);
+    bool HasProperty(std::string name) const;
 
     /**
      * @brief Check if a sub-section exists in this configuration file
@@ -176,7 +374,7 @@ public:
      * @param name Name of the sub-section, not including the name of this section
      * @returns `true` if the sub-section exists, otherwise `false`
      */
-    bool HasSubSection(std::string name);
+    bool HasSubSection(std::string name) const;
 
     /**
      * Add a configuration property with a specific type
@@ -201,14 +399,32 @@ public:
      * @returns All the available and read properties in given file
      */
     BgeConfigPropertyList& GetProperties();
+    const BgeConfigPropertyList& GetProperties() const;
 
     /**
      * @returns All the available and read sections in given file
      */
     BgeConfigSectionList& GetSubSections();
+    const BgeConfigSectionList& GetSubSections() const;
+
+    /**
+     * @brief Get a 64-bit structural hash of this section
+     * 
+     * @note The hash covers the name, all properties and all sub-sections. It is computed lazily
+     *       and cached until the section or one of its children changes through `AddProperty`,
+     *       `AddSubSection`, `BgeConfigProperty::SetValue` or `BgeConfig::Set`. Values assigned to
+     *       the property fields directly are only picked up after a call to `InvalidateHash`.
+     */
+    uint64_t Hash();
 
     /**
-     * @brief Compare if two `BgeConfigSection` objects are equal
+     * @brief Throw away the cached hash of this section and all of its parents
+     */
+    void InvalidateHash();
+
+    /**
+     * @brief Compare if two `BgeConfigSection` objects are equal (by name, properties and sub-sections)
+     * @note Sections whose cached hashes differ are told apart without comparing their properties
      */
     bool operator==(BgeConfigSection& other);
 
@@ -224,12 +440,56 @@ public:
 
 private:
     BgeConfigPropertyList::iterator GetPropertyIterator(std::string name);
+    BgeConfigPropertyList::const_iterator GetPropertyIterator(std::string name) const;
     BgeConfigSectionList::iterator GetSectionIterator(std::string name);
+    BgeConfigSectionList::const_iterator GetSectionIterator(std::string name) const;
+
+    /**
+     * @brief Points the parent of every direct property and sub-section back to this section
+     * @note Needed whenever this section changed its address (e.g. when the owning list grows)
+     */
+    void RelinkChildren();
+
+    /**
+     * @brief Compare all properties and sub-sections by name and value, see `operator==`
+     */
+    bool Equals(BgeConfigSection& other);
 
 private:
     BgeConfigSectionList mNestedSections;
     BgeConfigPropertyList mProperties;
     BgeConfigSection* mParent;
+
+    // Cached structural hash, `0` if it has to be recomputed
+    std::atomic<uint64_t> mHash;
+};
+
+#ifndef BGE_CONFIG_PARSE_CHUNK
+#   define BGE_CONFIG_PARSE_CHUNK 65536
+#endif
+
+/**
+ * Receives the contents of a configuration while `BgeConfig::Parse` scans it
+ * @note The views passed to the callbacks are only valid until the callback returns
+*/
+struct BgeConfigVisitor
+{
+    virtual ~BgeConfigVisitor() = default;
+
+    /**
+     * Called for every section header
+     * @param fullName Full name of the section, e.g. "General.Editor"
+    */
+    virtual void OnSection(std::string_view /*fullName*/) {}
+
+    /**
+     * Called for every property
+     * 
+     * @param fullName Full name of the property including all of its sections
+     * @param type Estimated type of the value
+     * @param value Value as written in the file, strings without their quotes
+    */
+    virtual void OnProperty(std::string_view /*fullName*/, BgePropertyValueType /*type*/, std::string_view /*value*/) {}
 };
 
 /**
@@ -243,6 +503,16 @@ struct BgeConfig
     */
     BgeConfig();
 
+    /**
+     * Copies the configuration tree of another `BgeConfig` object
+     * @note The journal and `OnChange` callbacks are not copied
+    */
+    BgeConfig(const BgeConfig& other);
+    BgeConfig& operator=(const BgeConfig& other);
+
+    BgeConfig(BgeConfig&& other) = default;
+    BgeConfig& operator=(BgeConfig&& other) = default;
+
     /**
      * Closes this `BgeConfig` object
      * @note this does NOT save the configuration automatically
@@ -251,15 +521,190 @@ struct BgeConfig
 
     /**
      * Open and load a configuration file
+     * @note If there is an edit journal next to the file, it is replayed on top
      * @param path file path to the configuration file to load
+     * @returns `true` if the file could be opened, otherwise `false`
+    */
+    bool Open(std::string path);
+
+    /**
+     * Opens many configuration files at once on a pool of threads
+     * 
+     * @param paths file paths to the configuration files
+     * @param threadCount number of threads to use, `0` uses one per hardware thread
+     * 
+     * @returns One configuration per path in the same order, `nullptr` where the file could not be opened
+    */
+    static std::vector<std::unique_ptr<BgeConfig>> OpenMany(std::vector<std::string> paths, size_t threadCount = 0);
+
+    /**
+     * Opens many configuration files at once on a pool of threads and merges them into this
+     * configuration, every file into its own prefix section
+     * 
+     * @note The files are merged in order after all of them were parsed, properties that already
+     *       exist are kept. The merged configuration has no path, see `OpenFromMemory`.
+     * 
+     * @param files file paths and prefix sections of the configuration files
+     * @param threadCount number of threads to use, `0` uses one per hardware thread
+     * 
+     * @returns `true` if every file could be opened, otherwise `false`
+    */
+    bool OpenMany(std::vector<BgeConfigMergeEntry> files, size_t threadCount = 0);
+
+    /**
+     * Load a configuration from text in memory, e.g. an embedded resource
+     * 
+     * @note The configuration has no path afterwards, so `Reload` and the edit journal are
+     *       not available. The text is copied if formatting is preserved, otherwise it only
+     *       has to stay valid during this call.
+     * 
+     * @param text configuration text
+    */
+    void OpenFromMemory(std::string_view text);
+
+    /**
+     * Load a configuration from a part of an already opened file, e.g. a packed archive
+     * 
+     * @note The configuration has no path afterwards, see `OpenFromMemory`.
+     *       The cursor of `file` is left behind the read part.
+     * 
+     * @param file file opened for reading
+     * @param offset offset of the configuration text inside of the file
+     * @param length length of the configuration text in bytes
+     * 
+     * @returns `true` if the part could be read, otherwise `false`
+    */
+    bool OpenFromFile(BgeFile& file, uint64_t offset, size_t length);
+
+    /**
+     * Scans a configuration file without building a configuration tree
+     * 
+     * @note The file is read in chunks of `BGE_CONFIG_PARSE_CHUNK` bytes, no sections or
+     *       properties are created. Sections are reported in the order of their headers,
+     *       properties with the full name they would get in `Open`. Files bigger than
+     *       `BGE_FILE_SEQUENTIAL_HINT` are read with a sequential access hint and their pages
+     *       are dropped from the page cache once scanned, so they don't push out anything else.
+     * 
+     * @param path file path to the configuration file to scan
+     * @param visitor receives every section and property
+     * 
+     * @returns `true` if the file could be opened, otherwise `false`
+    */
+    static bool Parse(std::string path, BgeConfigVisitor& visitor);
+
+    /**
+     * Does the same as `Parse` but scans configuration text that is already in memory
+     * @param text configuration text
+     * @param visitor receives every section and property
+    */
+    static void ParseFromMemory(std::string_view text, BgeConfigVisitor& visitor);
+
+    /**
+     * Reloads the configuration file that was last opened
+     * 
+     * @note Only sections whose bytes changed get reparsed, unchanged `BgeConfigSection`
+     *       objects and pointers into them stay intact. Pointers to properties of changed
+     *       sections become invalid. If sections were added or removed, the whole file
+     *       is parsed again like `Open` would do.
+     * 
+     * @returns `true` if the file could be opened, otherwise `false`
     */
-    void Open(std::string path);
+    bool Reload();
+
+    /**
+     * @returns The path of the last opened configuration file
+    */
+    std::string GetPath();
+
+    /**
+     * @returns A number that changes whenever properties or sections of this configuration may
+     *          have moved in memory (open, reload, new properties or sections), pointers to them
+     *          taken at an older generation may be invalid
+    */
+    uint64_t GetGeneration();
+
+    /**
+     * Registers a callback that is called after `Reload` changed the type or value of a property
+     * 
+     * @note A pattern is either the full name of a single property, a section followed by
+     *       ".*" for every property inside of that section (and its sub-sections) or just "*"
+     *       for every property
+     * 
+     * @param pattern Names of the properties, e.g. "General.Editor.*"
+     * @param callback Function that is called for every changed, added or removed property
+     * 
+     * @returns An id that can be used to remove the callback again
+    */
+    size_t OnChange(std::string pattern, BgeConfigChangeCallback callback);
+
+    /**
+     * Removes a callback registered with `OnChange`
+     * @param id The id returned by `OnChange`
+    */
+    void RemoveOnChange(size_t id);
 
     /**
      * Saves this configuration to a desired path
+     * 
+     * @note The file is replaced atomically, see `BgeFileFlags::ATOMIC`. With more than one
+     *       thread every top-level section is serialized into its own buffer on a worker
+     *       thread, the output is the same as with a single thread
+     * 
      * @param path output file path
+     * @param threadCount number of threads to use, `0` picks one automatically depending on the size of the configuration
+    */
+    void Save(std::string path, size_t threadCount = 0);
+
+    /**
+     * Keep the text of opened files to preserve their formatting when saving (enabled by default)
+     * 
+     * @note `Save` then copies everything that wasn't edited (comments, whitespaces, ...)
+     *       straight from the opened file and only writes the edited properties again. New
+     *       properties go right below the last one of their section. If sections were added,
+     *       removed or renamed, or a section without any properties got new ones, the whole
+     *       file is written from scratch instead.
+     * 
+     * @param preserve `true` to keep the text of the next opened file, `false` to drop it
+    */
+    void SetPreserveFormatting(bool preserve);
+
+    /**
+     * Starts recording every change made through `AddProperty` and `Set` into an edit journal
+     * 
+     * @note The journal lives next to the configuration file (`<path>.journal`) and only holds
+     *       small records of the changes, so the file doesn't have to be saved after every edit.
+     *       `Open` replays it on top of the file, saving to the path of the configuration or
+     *       `Compact` fold it back into the file.
+     * 
+     * @returns `true` if the journal could be opened, otherwise `false`
+    */
+    bool EnableJournal();
+
+    /**
+     * Stops recording changes, the journal file itself stays until the next save
+    */
+    void DisableJournal();
+
+    /**
+     * Folds the edit journal into a fresh save of the configuration file on a background thread
+     * 
+     * @note The current state is copied before returning, changes made afterwards go into
+     *       a new journal and are not lost
+     * 
+     * @returns A future that becomes `true` once the file was saved successfully
+    */
+    std::shared_future<bool> Compact();
+
+    /**
+     * Sets the value of a property, the property is created if it doesn't exist yet
+     * @param name name of the property
+     * @param value new value
     */
-    void Save(std::string path);
+    void Set(std::string name, int value);
+    void Set(std::string name, float value);
+    void Set(std::string name, bool value);
+    void Set(std::string name, std::string value);
+    void Set(std::string name, const char* value);
 
     /**
      * Adds a configuration property with a specific type
@@ -283,7 +728,7 @@ struct BgeConfig
      * @param name Name of the property
      * @returns `true` if the property exists, otherwise `false`
      */
-    bool HasProperty(std::string name);
+    bool HasProperty(std::string name) const;
 
     /**
      * @brief Check if a section exists in this configuration file
@@ -291,7 +736,7 @@ struct BgeConfig
      * @param name Name of the section
      * @returns `true` if the section exists, otherwise `false`
      */
-    bool HasSection(std::string name);
+    bool HasSection(std::string name) const;
 
     /**
      * Gets a specific property of this configuration file
@@ -299,6 +744,7 @@ struct BgeConfig
      * @returns desired property, NULL if not found
     */
     BgeConfigProperty* Get(std::string name);
+    const BgeConfigProperty* Get(std::string name) const;
 
     /**
      * Gets a specific section of this configuration file
@@ -306,16 +752,19 @@ struct BgeConfig
      * @returns desired section, NULL if not found
     */
     BgeConfigSection* GetSection(std::string name);
+    const BgeConfigSection* GetSection(std::string name) const;
 
     /**
      * @returns All the globally available and read properties in given file
      */
     BgeConfigPropertyList& GetProperties();
+    const BgeConfigPropertyList& GetProperties() const;
 
     /**
      * @returns All the globally available and read sections in given file
      */
     BgeConfigSectionList& GetSections();
+    const BgeConfigSectionList& GetSections() const;
 
     /**
      * Estimates the type a given string could have
@@ -324,87 +773,552 @@ struct BgeConfig
      *   
      * @returns the type of `value`
     */
-    static BgePropertyValueType EstimateValueType(std::string value);
-
-private:
-    BgeConfigPropertyList::iterator GetPropertyIterator(std::string name);
+    static BgePropertyValueType EstimateValueType(std::string_view value);
 
-    BgeConfigSectionList::iterator GetSectionIterator(std::string name);
+    /**
+     * Compares two configurations
+     * @note Only sub-trees whose hashes differ are compared property by property
+     * @returns Every property that was added, removed or changed its type or value
+    */
+    static BgeConfigDifferenceList Diff(BgeConfig& a, BgeConfig& b);
 
     /**
-     * Checks if given string is a number
-     * 
-     * @param[in] str input string
-     * 
-     * @returns true if it is a number, false otherwise
+     * Compares two sections, including their sub-sections
+     * @note Only sub-trees whose hashes differ are compared property by property
+     * @returns Every property that was added, removed or changed its type or value
     */
-    static bool StringIsNumber(std::string str);
+    static BgeConfigDifferenceList Diff(BgeConfigSection& a, BgeConfigSection& b);
 
     /**
-     * Checks if given string is a floating point number
+     * Hashes a range of bytes (64-bit FNV-1a)
      * 
-     * @param[in] str input string
+     * @param[in] data input bytes
+     * @param[in] seed hash to continue from
      * 
-     * @returns true if it is a floating point number, false otherwise
+     * @returns the hash of the bytes
     */
-    static bool StringIsFloat(std::string str);
+    static uint64_t HashBytes(std::string_view data, uint64_t seed = 14695981039346656037ull);
 
+private:
     /**
-     * Checks if given string is a bool
-     * 
-     * @param[in] str input string
-     * 
-     * @returns true if it is a bool, false otherwise
+     * A range of lines belonging to one section header (or to the global address space)
     */
-    static bool StringIsBool(std::string str);
+    struct SectionBlock
+    {
+        // Name of the section as written in the header, empty for the global address space
+        std::string Name;
+
+        // Range of the block inside the source text, including the header line
+        size_t Begin;
+        size_t End;
+    };
 
     /**
-     * Removes all whitespaces from the start and end of a string
-     * 
-     * @param[in] str input string
-     * 
-     * @returns cleared string without whitespaces at the start and end
+     * Content hash of every block that belongs to one section
     */
-    static std::string StringTrimLeading(std::string str);
+    struct SectionHash
+    {
+        // Combined hash of all the block bytes
+        uint64_t Hash;
+
+        // Number of blocks with this name
+        size_t BlockCount;
+
+        // Set if a property name of the block reaches into a sub-section (e.g. "Sub.Name = 1")
+        bool NestedNames;
+    };
+
+    using SectionHashMap = std::unordered_map<std::string, SectionHash>;
 
     /**
-     * Removes all "single-lined comments" ( "//" ) from a string
-     * 
-     * @param[in] str input string
-     * 
-     * @returns cleared string without "comments"
+     * A change to the source text when saving with preserved formatting
     */
-    static std::string StringTrimComment(std::string str);
+    struct SourceEdit
+    {
+        enum class Kind : uint8_t
+        {
+            VALUE,  // replace the value of a property
+            LINE,   // replace name and value of a renamed property
+            INSERT, // add a new property after the line of another one
+        };
 
-private:
-    BgeConfigPropertyList mProperties;
-    BgeConfigSectionList mSections;
-};
+        // Range of the source text that gets replaced
+        size_t Begin;
+        size_t End;
 
+        Kind Type;
+        BgeConfigProperty* Property;
 
-////////////////////////////////
-///                          ///
-/// FUNCTION IMPLEMENTATIONS ///
-///                          ///
-////////////////////////////////
+        // Indentation of new lines, or the section part of a renamed property name
+        std::string_view Prefix;
 
-/////////////////////////
-/// BgeConfigProperty ///
-/////////////////////////
+        // Quote character around string values, `0` if there is none
+        char Quote;
+    };
 
-BgeConfigProperty::BgeConfigProperty()
-    : mParent(nullptr)
-{
-    Type = BgePropertyValueType::UNKNOWN;
-    Name = "";
-    StrValue = "";
+    /**
+     * A callback registered through `OnChange`
+    */
+    struct ChangeSubscription
+    {
+        size_t Id;
+        BgeConfigChangeCallback Callback;
+    };
+
+    // Maps a property name (or section name for ".*" patterns) to its subscribers
+    using ChangeSubscriberMap = std::unordered_map<std::string, std::vector<ChangeSubscription>>;
+
+private:
+    BgeConfigPropertyList::iterator GetPropertyIterator(std::string name);
+    BgeConfigPropertyList::const_iterator GetPropertyIterator(std::string name) const;
+
+    BgeConfigSectionList::iterator GetSectionIterator(std::string name);
+    BgeConfigSectionList::const_iterator GetSectionIterator(std::string name) const;
+
+    /**
+     * Reads a whole file into memory
+     * 
+     * @param[in] path file path
+     * @param[out] text file contents
+     * 
+     * @returns `true` if the file could be opened, otherwise `false`
+    */
+    static bool ReadText(std::string path, std::string& text);
+
+    /**
+     * Saves the configuration tree to a file, without touching the journal
+     * @returns `true` if the file was written, otherwise `false`
+    */
+    bool SaveFile(std::string path, size_t threadCount);
+
+    /**
+     * Adds a property without writing it into the journal
+     * @returns `true` if the property was added, `false` if it already existed
+    */
+    bool InsertProperty(std::string name, BgeConfigProperty& property);
+
+    /**
+     * Overwrites the type and value of a property or adds it if it doesn't exist yet
+    */
+    void ApplyProperty(std::string name, BgeConfigProperty& property);
+
+    /**
+     * Applies and journals a changed property
+    */
+    void SetProperty(std::string name, BgeConfigProperty property);
+
+    /**
+     * Appends a record of a property to the journal
+    */
+    void WriteJournalRecord(std::string& name, BgeConfigProperty& property);
+
+    /**
+     * Applies every complete record of a journal file
+     * @note A torn record at the end (e.g. after a crash) ends the replay
+     * @returns `true` if the journal file existed, otherwise `false`
+    */
+    bool ReplayJournal(std::string path);
+
+    /**
+     * Replays the journal of the current configuration file and the one of an unfinished compaction
+     * @returns `true` if there was anything to replay
+    */
+    bool ReplayJournals();
+
+    /**
+     * @returns The path of the journal belonging to a configuration file
+    */
+    static std::string GetJournalPath(std::string path);
+
+    /**
+     * Checks if a file exists
+    */
+    static bool FileExists(std::string path);
+
+    /**
+     * Serializes runs of top-level sections into a few buffers on a pool of threads
+     * and appends the buffers in order
+     * 
+     * @param[in] emitter emitter to which the sections get appended
+     * @param[in] threadCount number of threads to use (including the calling one)
+    */
+    void SaveSectionsParallel(BgeConfigEmitter& emitter, size_t threadCount);
+
+    /**
+     * @returns Number of properties in all sections and sub-sections
+    */
+    static size_t CountProperties(BgeConfigSectionList& sections);
+
+    /**
+     * Calls a function once for every index below `count` on a pool of threads
+     * 
+     * @param[in] count number of indices
+     * @param[in] threadCount number of threads to use (including the calling one)
+     * @param[in] function function that is called with every index
+    */
+    static void ForEachParallel(size_t count, size_t threadCount, const std::function<void(size_t)>& function);
+
+    /**
+     * Copies all properties and sub-sections of a section into another one, existing properties are kept
+    */
+    static void MergeSection(BgeConfigSection& target, BgeConfigSection& source);
+
+    /**
+     * Parses a whole configuration text into this config
+     * @note Does not clear the config beforehand, keeps the text if formatting is preserved
+    */
+    void Load(std::string text);
+
+    /**
+     * Parses a whole configuration text into this config without keeping the text
+     * @note Does not clear the config beforehand
+     * @returns the blocks of the text
+    */
+    std::vector<SectionBlock> LoadText(std::string_view text);
+
+    /**
+     * Collects all changes needed to save this configuration on top of its source text
+     * @param[out] edits changes in order of the source text
+     * @returns `false` if the configuration has to be written from scratch, otherwise `true`
+    */
+    bool CollectSourceEdits(std::vector<SourceEdit>& edits);
+
+    /**
+     * Collects the change of one property that was read from the source text
+    */
+    void CollectSourceEdit(BgeConfigProperty& property, std::vector<SourceEdit>& edits);
+
+    /**
+     * Collects the properties of a list that have to be inserted into the source text
+     * @returns `false` if the list has no line the new properties could follow, otherwise `true`
+    */
+    bool CollectSourceInserts(BgeConfigPropertyList& properties, std::vector<SourceEdit>& edits);
+
+    /**
+     * Writes the source text with all edits applied
+    */
+    void SaveSource(BgeConfigEmitter& emitter, std::vector<SourceEdit>& edits);
+
+    /**
+     * Moves the source spans of unchanged blocks to where they are in a reloaded text
+     * 
+     * @param[in] blocks blocks of the reloaded text
+     * @param[in] hashes section hashes of the reloaded text
+     * @param[in] sourceId id of the reloaded text
+    */
+    void RebaseSource(std::vector<SectionBlock>& blocks, SectionHashMap& hashes, uint64_t sourceId);
+
+    /**
+     * @returns Number of properties whose source span belongs to the current source text
+    */
+    size_t CountSourcedProperties(BgeConfigPropertyList& properties);
+    size_t CountSourcedProperties(BgeConfigSectionList& sections);
+
+    /**
+     * @returns Hash of the full names of all sections, to notice added, removed or renamed sections
+    */
+    static uint64_t SectionSignature(BgeConfigSectionList& sections, std::string& prefix);
+
+    /**
+     * Calls a function for every property inside of the sections and their sub-sections
+    */
+    static void ForEachProperty(BgeConfigSectionList& sections, const std::function<void(BgeConfigProperty&)>& function);
+
+    /**
+     * @returns A new id for a source text
+    */
+    static uint64_t NextSourceId();
+
+    /**
+     * @returns A new generation, unique over all configurations
+    */
+    static uint64_t NextGeneration();
+
+    /**
+     * Parses the properties of a single block into a section
+     * 
+     * @param[in] text the text of the block
+     * @param[in] section target section, `nullptr` for the global address space
+    */
+    void LoadBlock(std::string_view text, BgeConfigSection* section);
+
+    /**
+     * Splits a configuration text into its section blocks and hashes them
+     * 
+     * @param[in] text input text
+     * @param[out] blocks blocks in order of appearance
+     * @param[out] hashes hash of every section
+    */
+    static void SplitBlocks(std::string_view text, std::vector<SectionBlock>& blocks, SectionHashMap& hashes);
+
+    /**
+     * Creates a property from a line that has already been cleaned with `CleanLine`
+     * 
+     * @param[in] line input line
+     * @param[out] property parsed property
+     * 
+     * @returns `true` if the line contains a property, otherwise `false`
+    */
+    static bool ParseProperty(std::string_view line, BgeConfigProperty& property);
+
+    /**
+     * Estimates the type of a trimmed value and removes the quotes around strings
+     * 
+     * @param[in] value trimmed value
+     * @param[out] type estimated type of the value
+     * 
+     * @returns the value without quotes
+    */
+    static std::string_view ParseValue(std::string_view value, BgePropertyValueType& type);
+
+    /**
+     * Reports one line of a configuration to a visitor
+     * 
+     * @param[in] line input line, not cleaned yet
+     * @param[in] visitor receives the section or property of the line
+     * @param[in,out] fullName name of the current section, followed by the last property name
+     * @param[in,out] sectionLength length of the name of the current section inside `fullName`
+    */
+    static void VisitLine(std::string_view line, BgeConfigVisitor& visitor, std::string& fullName, size_t& sectionLength);
+
+    /**
+     * Removes comments and surrounding whitespaces of a line without copying it
+     * 
+     * @param[in] line input line
+     * 
+     * @returns the cleaned line, empty if there is nothing to parse
+    */
+    static std::string_view CleanLine(std::string_view line);
+
+    /**
+     * Removes whitespaces from the start and end of a string without copying it
+     * @note Behaves like `StringTrimLeading`
+     * 
+     * @param[in] str input string
+     * 
+     * @returns the trimmed string, empty if it only contains whitespaces
+    */
+    static std::string_view TrimView(std::string_view str);
+
+    /**
+     * Checks if a cleaned line is a section header and extracts its name
+     * 
+     * @param[in] line input line
+     * @param[out] name section name
+     * 
+     * @returns `true` if the line is a section header, otherwise `false`
+    */
+    static bool ParseSectionHeader(std::string_view line, std::string_view& name);
+
+    /**
+     * Collects all properties whose type or value differ between two property lists
+     * 
+     * @param[in] previous properties of the first configuration
+     * @param[in] current properties of the second configuration
+     * @param[in] prefix full name of the section holding the properties
+     * @param[out] changes list of changed properties
+    */
+    static void DiffProperties(BgeConfigPropertyList& previous, BgeConfigPropertyList& current, std::string prefix, BgeConfigDifferenceList& changes);
+
+    /**
+     * Collects all properties whose type or value differ between two section lists
+     * @note Sections with the same name and hash are skipped without looking at their properties
+     * 
+     * @param[in] previous sections of the first configuration
+     * @param[in] current sections of the second configuration
+     * @param[in] prefix full name of the section holding the sections
+     * @param[out] changes list of changed properties
+    */
+    static void DiffSections(BgeConfigSectionList& previous, BgeConfigSectionList& current, std::string prefix, BgeConfigDifferenceList& changes);
+
+    /**
+     * Calls the subscribers of every changed property
+    */
+    void NotifyChanges(BgeConfigDifferenceList& changes);
+
+    /**
+     * Checks if given string is a number
+     * 
+     * @param[in] str input string
+     * 
+     * @returns true if it is a number, false otherwise
+    */
+    static bool StringIsNumber(std::string_view str);
+
+    /**
+     * Checks if given string is a floating point number
+     * 
+     * @param[in] str input string
+     * 
+     * @returns true if it is a floating point number, false otherwise
+    */
+    static bool StringIsFloat(std::string_view str);
+
+    /**
+     * Checks if given string is a bool
+     * 
+     * @param[in] str input string
+     * 
+     * @returns true if it is a bool, false otherwise
+    */
+    static bool StringIsBool(std::string_view str);
+
+    /**
+     * Converts a string to a float independent of the current locale
+     * 
+     * @param[in] str input string, has to pass `StringIsFloat`
+     * 
+     * @returns the nearest float, `0` if the string is no valid float
+    */
+    static float StringToFloat(std::string_view str);
+
+    /**
+     * Removes all whitespaces from the start and end of a string
+     * 
+     * @param[in] str input string
+     * 
+     * @returns cleared string without whitespaces at the start and end
+    */
+    static std::string StringTrimLeading(std::string str);
+
+    /**
+     * Removes all "single-lined comments" ( "//" ) from a string
+     * 
+     * @param[in] str input string
+     * 
+     * @returns cleared string without "comments"
+    */
+    static std::string StringTrimComment(std::string str);
+
+private:
+    BgeConfigPropertyList mProperties;
+    BgeConfigSectionList mSections;
+    SectionHashMap mSectionHashes;
+    std::string mPath;
+    ChangeSubscriberMap mExactSubscribers;
+    ChangeSubscriberMap mPrefixSubscribers;
+    size_t mNextSubscriptionId;
+    std::unique_ptr<BgeFile> mJournal;
+    std::shared_future<bool> mCompaction;
+
+    // Text of the opened file, empty if formatting isn't preserved
+    std::string mSource;
+    uint64_t mSourceId;
+    std::vector<SectionBlock> mSourceBlocks;
+    size_t mSourcePropertyCount;
+    uint64_t mSourceSignature;
+    bool mPreserveFormatting;
+
+    uint64_t mGeneration;
+};
+
+
+////////////////////////////////
+///                          ///
+/// FUNCTION IMPLEMENTATIONS ///
+///                          ///
+////////////////////////////////
+
+////////////////////////
+/// BgeConfigEmitter ///
+////////////////////////
+
+BgeConfigEmitter::BgeConfigEmitter(BgeFile* file, size_t capacity)
+    : mBuffer(capacity < 64 ? 64 : capacity), mLength(0), mFile(file)
+{
+}
+
+BgeConfigEmitter::~BgeConfigEmitter()
+{
+    Flush();
+}
+
+void BgeConfigEmitter::Append(std::string_view text)
+{
+    // big chunks of text don't need to take a detour through the buffer
+    if (mFile != nullptr && text.size() >= mBuffer.size())
+    {
+        Flush();
+        mFile->Write(text.data(), sizeof(char), text.size());
+        return;
+    }
+
+    memcpy(Reserve(text.size()), text.data(), text.size());
+    mLength += text.size();
+}
+
+void BgeConfigEmitter::Append(char chr)
+{
+    *Reserve(1) = chr;
+    mLength++;
+}
+
+void BgeConfigEmitter::AppendInt(int value)
+{
+    char* output = Reserve(16);
+    mLength += std::to_chars(output, output + 16, value).ptr - output;
+}
+
+void BgeConfigEmitter::AppendFloat(float value)
+{
+    // 64 bytes fit every float in fixed notation, even FLT_MAX and the smallest denormals
+    char* output = Reserve(64);
+    char* outputEnd = std::to_chars(output, output + 62, value, std::chars_format::fixed).ptr;
+
+    // keep a decimal point, otherwise the value would be read back as an integer
+    if (std::isfinite(value) && std::find(output, outputEnd, '.') == outputEnd)
+    {
+        *outputEnd++ = '.';
+        *outputEnd++ = '0';
+    }
+
+    mLength += outputEnd - output;
+}
+
+void BgeConfigEmitter::Flush()
+{
+    if (mFile == nullptr || mLength == 0)
+        return;
+
+    mFile->Write(mBuffer.data(), sizeof(char), mLength);
+    mLength = 0;
+}
+
+std::string_view BgeConfigEmitter::View()
+{
+    return std::string_view(mBuffer.data(), mLength);
+}
+
+char* BgeConfigEmitter::Reserve(size_t size)
+{
+    if (mLength + size <= mBuffer.size())
+        return mBuffer.data() + mLength;
+
+    Flush();
+
+    if (mLength + size > mBuffer.size())
+        mBuffer.resize(std::max(mBuffer.size() * 2, mLength + size));
+
+    return mBuffer.data() + mLength;
+}
+
+/////////////////////////
+/// BgeConfigProperty ///
+/////////////////////////
+
+BgeConfigProperty::BgeConfigProperty()
+    : mParent(nullptr), mSourceBegin(0), mSourceValueBegin(0), mSourceValueEnd(0), mSourceLineEnd(0), mSourceHash(0), mSourceId(0)
+{
+    Type = BgePropertyValueType::UNKNOWN;
+    Name = "";
+    StrValue = "";
     IntValue = 0;
     FloatValue = 0;
     BoolValue = false;
 }
 
 BgeConfigProperty::BgeConfigProperty(BgePropertyValueType type, std::string name, std::string strValue, int intValue, float floatValue, bool boolValue)
-    : mParent(nullptr)
+    : mParent(nullptr), mSourceBegin(0), mSourceValueBegin(0), mSourceValueEnd(0), mSourceLineEnd(0), mSourceHash(0), mSourceId(0)
 {
     Type = type;
     Name = name;
@@ -414,574 +1328,2161 @@ BgeConfigProperty::BgeConfigProperty(BgePropertyValueType type, std::string name
     BoolValue = boolValue;
 }
 
-std::string BgeConfigProperty::GetFullName()
+std::string BgeConfigProperty::GetFullName()
+{
+    if (!mParent)
+        return Name;
+
+    return std::string(mParent->GetFullName()).append(".").append(Name);
+}
+
+void BgeConfigProperty::Save(BgeFile& file)
+{
+    BgeConfigEmitter emitter = BgeConfigEmitter(&file, 256);
+    Save(emitter);
+}
+
+void BgeConfigProperty::Save(BgeConfigEmitter& emitter)
+{
+    emitter.Append(Name);
+    emitter.Append(" = ");
+    SaveValue(emitter);
+    emitter.Append('\n');
+}
+
+void BgeConfigProperty::SaveValue(BgeConfigEmitter& emitter)
+{
+    switch(Type)
+    {
+        case BgePropertyValueType::INT:
+            emitter.AppendInt(IntValue);
+            break;
+
+        case BgePropertyValueType::FLOAT:
+            emitter.AppendFloat(FloatValue);
+            break;
+        
+        case BgePropertyValueType::BOOL:
+            emitter.Append(BoolValue ? "true" : "false");
+            break;
+
+        default:
+        case BgePropertyValueType::UNKNOWN:
+        case BgePropertyValueType::STRING:
+            emitter.Append(StrValue);
+            break;
+    }
+}
+
+bool BgeConfigProperty::operator==(BgeConfigProperty& other)
+{
+    return Type == other.Type && Name == other.Name; // it is enough if the name and type are the same
+}
+
+bool BgeConfigProperty::operator!=(BgeConfigProperty& other)
+{
+    return !operator==(other);
+}
+
+uint64_t BgeConfigProperty::Hash()
+{
+    uint64_t valueHash = ValueHash();
+    return BgeConfig::HashBytes(std::string_view((const char*)&valueHash, sizeof(valueHash)), BgeConfig::HashBytes(Name));
+}
+
+uint64_t BgeConfigProperty::ValueHash()
+{
+    uint64_t hash = BgeConfig::HashBytes(std::string_view((const char*)&Type, sizeof(Type)));
+
+    switch(Type)
+    {
+        case BgePropertyValueType::INT:
+            return BgeConfig::HashBytes(std::string_view((const char*)&IntValue, sizeof(IntValue)), hash);
+
+        case BgePropertyValueType::FLOAT:
+        {
+            // -0.0 and 0.0 are equal values, so they have to hash the same
+            float value = (FloatValue == 0.f) ? 0.f : FloatValue;
+            return BgeConfig::HashBytes(std::string_view((const char*)&value, sizeof(value)), hash);
+        }
+
+        case BgePropertyValueType::BOOL:
+            return BgeConfig::HashBytes(BoolValue ? "1" : "0", hash);
+
+        default:
+        case BgePropertyValueType::UNKNOWN:
+        case BgePropertyValueType::STRING:
+            return BgeConfig::HashBytes(StrValue, hash);
+    }
+}
+
+bool BgeConfigProperty::ValueEquals(BgeConfigProperty& other)
+{
+    if (Type != other.Type)
+        return false;
+
+    switch(Type)
+    {
+        case BgePropertyValueType::INT:
+            return IntValue == other.IntValue;
+
+        case BgePropertyValueType::FLOAT:
+            return FloatValue == other.FloatValue;
+
+        case BgePropertyValueType::BOOL:
+            return BoolValue == other.BoolValue;
+
+        default:
+        case BgePropertyValueType::UNKNOWN:
+        case BgePropertyValueType::STRING:
+            return StrValue == other.StrValue;
+    }
+}
+
+void BgeConfigProperty::SetValue(int value)
+{
+    Type = BgePropertyValueType::INT;
+    IntValue = value;
+    if (mParent != nullptr)
+        mParent->InvalidateHash();
+}
+
+void BgeConfigProperty::SetValue(float value)
+{
+    Type = BgePropertyValueType::FLOAT;
+    FloatValue = value;
+    if (mParent != nullptr)
+        mParent->InvalidateHash();
+}
+
+void BgeConfigProperty::SetValue(bool value)
+{
+    Type = BgePropertyValueType::BOOL;
+    BoolValue = value;
+    if (mParent != nullptr)
+        mParent->InvalidateHash();
+}
+
+void BgeConfigProperty::SetValue(std::string value)
+{
+    Type = BgePropertyValueType::STRING;
+    StrValue = std::move(value);
+    if (mParent != nullptr)
+        mParent->InvalidateHash();
+}
+
+void BgeConfigProperty::SetValue(const char* value)
+{
+    SetValue(std::string(value));
+}
+
+void BgeConfigProperty::SetParent(BgeConfigSection* parent)
+{
+    mParent = parent;
+}
+
+BgeConfigSection* BgeConfigProperty::GetParent()
+{
+    return mParent;
+}
+
+////////////////////////
+/// BgeConfigSection ///
+////////////////////////
+
+BgeConfigSection::BgeConfigSection()
+    : Name(), mProperties(), mNestedSections(), mParent(nullptr), mHash(0)
+{
+}
+
+BgeConfigSection::BgeConfigSection(std::string name)
+    : Name(name), mParent(nullptr), mHash(0)
+{
+}
+
+BgeConfigSection::BgeConfigSection(const BgeConfigSection& other)
+    : Name(other.Name), mNestedSections(other.mNestedSections), mProperties(other.mProperties), mParent(other.mParent),
+      mHash(other.mHash.load(std::memory_order_relaxed))
+{
+    RelinkChildren();
+}
+
+BgeConfigSection::BgeConfigSection(BgeConfigSection&& other) noexcept
+    : Name(std::move(other.Name)), mNestedSections(std::move(other.mNestedSections)), mProperties(std::move(other.mProperties)), mParent(other.mParent),
+      mHash(other.mHash.load(std::memory_order_relaxed))
+{
+    RelinkChildren();
+}
+
+BgeConfigSection& BgeConfigSection::operator=(const BgeConfigSection& other)
+{
+    if (this == &other)
+        return *this;
+
+    Name = other.Name;
+    mNestedSections = other.mNestedSections;
+    mProperties = other.mProperties;
+    mParent = other.mParent;
+    mHash.store(other.mHash.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    RelinkChildren();
+    return *this;
+}
+
+BgeConfigSection& BgeConfigSection::operator=(BgeConfigSection&& other) noexcept
+{
+    if (this == &other)
+        return *this;
+
+    Name = std::move(other.Name);
+    mNestedSections = std::move(other.mNestedSections);
+    mProperties = std::move(other.mProperties);
+    mParent = other.mParent;
+    mHash.store(other.mHash.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    RelinkChildren();
+    return *this;
+}
+
+std::string BgeConfigSection::GetFullName()
+{
+    if (!mParent)
+        return Name;
+
+    return std::string(mParent->GetFullName()).append(".").append(Name);
+}
+
+void BgeConfigSection::Save(BgeFile& file, std::string sectionPrefix)
+{
+    BgeConfigEmitter emitter = BgeConfigEmitter(&file);
+    Save(emitter, sectionPrefix);
+}
+
+void BgeConfigSection::Save(BgeConfigEmitter& emitter, std::string& sectionPrefix)
+{
+    // the prefix is extended in place and cut back afterwards instead of building new strings
+    size_t prefixLength = sectionPrefix.length();
+    if (!sectionPrefix.empty())
+        sectionPrefix.push_back('.');
+    sectionPrefix.append(Name);
+
+    emitter.Append('[');
+    emitter.Append(sectionPrefix);
+    emitter.Append("]\n");
+    for (auto& property : mProperties)
+        property.Save(emitter);
+    emitter.Append('\n');
+
+    for (auto& subSection : mNestedSections)
+        subSection.Save(emitter, sectionPrefix);
+
+    sectionPrefix.resize(prefixLength);
+}
+
+BgeConfigProperty* BgeConfigSection::Get(std::string name)
+{
+    if (name.empty())
+        return nullptr;
+
+    size_t sectionDivider = name.find_first_of('.');
+    if (sectionDivider == std::string::npos)
+    {
+        auto propertyIterator = GetPropertyIterator(name);
+        return (propertyIterator == mProperties.end()) ? nullptr : &*propertyIterator;
+    }
+
+    std::string sectionName = name.substr(0, sectionDivider);
+    std::string nextSectionName = name.substr(sectionDivider+1);
+
+    if (!HasSubSection(sectionName))
+        return nullptr;
+
+    return GetSubSection(sectionName)->Get(nextSectionName);
+}
+
+BgeConfigSection* BgeConfigSection::GetSubSection(std::string name)
+{
+    if (name.empty())
+        return nullptr;
+
+    size_t sectionDivider = name.find_first_of('.');
+    if (sectionDivider == std::string::npos)
+    {
+        auto sectionIterator = GetSectionIterator(name);
+        return (sectionIterator == mNestedSections.end()) ? nullptr : &*sectionIterator;
+    }
+
+    std::string sectionName = name.substr(0, sectionDivider);
+    std::string nextSectionName = name.substr(sectionDivider+1);
+
+    if (!HasSubSection(sectionName))
+        return nullptr;
+    
+    return GetSubSection(sectionName)->GetSubSection(nextSectionName);
+}
+
+bool BgeConfigSection::HasProperty(std::string name) const
+{
+    if (name.empty())
+        return false;
+
+    size_t sectionDivider = name.find_first_of('.');
+    if (sectionDivider == std::string::npos)
+        return GetPropertyIterator(name) != mProperties.end();
+
+    std::string sectionName = name.substr(0, sectionDivider);
+    std::string nextSectionName = name.substr(sectionDivider+1);
+
+    if (!HasSubSection(sectionName))
+        return false;
+    
+    return GetSubSection(sectionName)->HasProperty(nextSectionName);
+}
+
+bool BgeConfigSection::HasSubSection(std::string name) const
+{
+    if (name.empty())
+        return false;
+
+    size_t sectionDivider = name.find_first_of('.');
+    if (sectionDivider == std::string::npos)
+        return GetSectionIterator(name) != mNestedSections.end();
+    
+    std::string sectionName = name.substr(0, sectionDivider);
+    std::string nextSectionName = name.substr(sectionDivider+1);
+
+    if (!HasSubSection(sectionName))
+        return false;
+    
+    return GetSubSection(sectionName)->HasSubSection(nextSectionName);
+}
+
+void BgeConfigSection::AddProperty(std::string name, BgeConfigProperty& property)
+{
+    if (name.empty())
+        return;
+
+    if (HasProperty(name))
+        return;
+    
+    size_t sectionDivider = name.find_first_of('.');
+    if (sectionDivider == std::string::npos)
+    {
+        property.Name = name;
+        property.SetParent(this);
+        mProperties.push_back(property);
+        InvalidateHash();
+        return;
+    }
+
+    std::string sectionName = name.substr(0, sectionDivider);
+    std::string nextSectionStr = name.substr(sectionDivider+1);
+
+    BgeConfigSection* nextSection = nullptr;
+    if (!HasSubSection(sectionName))
+        nextSection = AddSubSection(sectionName);
+    else
+        nextSection = GetSubSection(sectionName);
+
+    if (nextSection == nullptr)
+        return;
+
+    nextSection->AddProperty(nextSectionStr, property);
+}
+
+BgeConfigSection* BgeConfigSection::AddSubSection(std::string name)
+{
+    if (name.empty())
+        return nullptr;
+
+    if (HasSubSection(name))
+        return GetSubSection(name);
+
+    size_t sectionDivider = name.find_first_of('.');
+    if (sectionDivider == std::string::npos)
+    {
+        BgeConfigSection section = BgeConfigSection(name);
+        section.SetParent(this);
+        mNestedSections.push_back(section);
+        InvalidateHash();
+        return &mNestedSections.back();
+    }
+
+    std::string sectionName = name.substr(0, sectionDivider);
+    std::string nextSectionName = name.substr(sectionDivider+1);
+
+    return AddSubSection(sectionName)->AddSubSection(nextSectionName);
+}
+
+BgeConfigPropertyList& BgeConfigSection::GetProperties()
+{
+    return mProperties;
+}
+
+BgeConfigSectionList& BgeConfigSection::GetSubSections()
+{
+    return mNestedSections;
+}
+
+const BgeConfigPropertyList& BgeConfigSection::GetProperties() const
+{
+    return mProperties;
+}
+
+const BgeConfigSectionList& BgeConfigSection::GetSubSections() const
+{
+    return mNestedSections;
+}
+
+const BgeConfigProperty* BgeConfigSection::Get(std::string name) const
+{
+    return const_cast<BgeConfigSection*>(this)->Get(name);
+}
+
+const BgeConfigSection* BgeConfigSection::GetSubSection(std::string name) const
+{
+    return const_cast<BgeConfigSection*>(this)->GetSubSection(name);
+}
+
+uint64_t BgeConfigSection::Hash()
+{
+    uint64_t hash = mHash.load(std::memory_order_acquire);
+    if (hash != 0)
+        return hash;
+
+    // children are summed up so that the hash doesn't depend on their order
+    uint64_t propertiesHash = 0;
+    for (auto& property : mProperties)
+    {
+        uint64_t propertyHash = property.Hash();
+        propertiesHash += BgeConfig::HashBytes(std::string_view((const char*)&propertyHash, sizeof(propertyHash)));
+    }
+
+    uint64_t sectionsHash = 0;
+    for (auto& subSection : mNestedSections)
+    {
+        uint64_t subSectionHash = subSection.Hash();
+        sectionsHash += BgeConfig::HashBytes(std::string_view((const char*)&subSectionHash, sizeof(subSectionHash)));
+    }
+
+    hash = BgeConfig::HashBytes(Name);
+    hash = BgeConfig::HashBytes(std::string_view((const char*)&propertiesHash, sizeof(propertiesHash)), hash);
+    hash = BgeConfig::HashBytes(std::string_view((const char*)&sectionsHash, sizeof(sectionsHash)), hash);
+
+    // `0` marks an outdated hash
+    if (hash == 0)
+        hash = 1;
+
+    mHash.store(hash, std::memory_order_release);
+    return hash;
+}
+
+void BgeConfigSection::InvalidateHash()
+{
+    // if a section has no cached hash, neither do its parents
+    for (BgeConfigSection* section = this; section != nullptr; section = section->mParent)
+        if (section->mHash.exchange(0, std::memory_order_acq_rel) == 0)
+            break;
+}
+
+bool BgeConfigSection::operator==(BgeConfigSection& other)
+{
+    if (Name != other.Name || mProperties.size() != other.mProperties.size() || mNestedSections.size() != other.mNestedSections.size())
+        return false;
+
+    // different hashes rule out equality, equal ones could still be a collision
+    return Hash() == other.Hash() && Equals(other);
+}
+
+bool BgeConfigSection::Equals(BgeConfigSection& other)
+{
+    std::unordered_map<std::string_view, BgeConfigProperty*> propertiesByName;
+    for (auto& property : other.mProperties)
+        propertiesByName.emplace(property.Name, &property);
+
+    for (auto& property : mProperties)
+    {
+        auto match = propertiesByName.find(property.Name);
+        if (match == propertiesByName.end() || !property.ValueEquals(*match->second))
+            return false;
+    }
+
+    std::unordered_map<std::string_view, BgeConfigSection*> sectionsByName;
+    for (auto& subSection : other.mNestedSections)
+        sectionsByName.emplace(subSection.Name, &subSection);
+
+    // sub-sections go through `operator==` again, so their cached hashes reject them early
+    for (auto& subSection : mNestedSections)
+    {
+        auto match = sectionsByName.find(subSection.Name);
+        if (match == sectionsByName.end() || subSection != *match->second)
+            return false;
+    }
+
+    return true;
+}
+
+bool BgeConfigSection::operator!=(BgeConfigSection& other)
+{
+    return !operator==(other);
+}
+
+void BgeConfigSection::SetParent(BgeConfigSection* parent)
+{
+    mParent = parent;
+}
+
+BgeConfigPropertyList::iterator BgeConfigSection::GetPropertyIterator(std::string name)
+{
+    return std::find_if(mProperties.begin(), mProperties.end(), [name](BgeConfigProperty& other){ return name == other.Name; });
+}
+
+BgeConfigPropertyList::const_iterator BgeConfigSection::GetPropertyIterator(std::string name) const
+{
+    return std::find_if(mProperties.begin(), mProperties.end(), [name](const BgeConfigProperty& other){ return name == other.Name; });
+}
+
+BgeConfigSectionList::iterator BgeConfigSection::GetSectionIterator(std::string name)
+{
+    return std::find_if(mNestedSections.begin(), mNestedSections.end(), [name](BgeConfigSection& other){ return name == other.Name; });
+}
+
+BgeConfigSectionList::const_iterator BgeConfigSection::GetSectionIterator(std::string name) const
+{
+    return std::find_if(mNestedSections.begin(), mNestedSections.end(), [name](const BgeConfigSection& other){ return name == other.Name; });
+}
+
+void BgeConfigSection::RelinkChildren()
+{
+    for (auto& property : mProperties)
+        property.SetParent(this);
+
+    for (auto& subSection : mNestedSections)
+        subSection.SetParent(this);
+}
+
+/////////////////
+/// BgeConfig ///
+/////////////////
+
+BgeConfig::BgeConfig()
+    : mProperties(), mSections(), mSectionHashes(), mPath(), mExactSubscribers(), mPrefixSubscribers(), mNextSubscriptionId(0),
+      mJournal(), mCompaction(), mSource(), mSourceId(0), mSourceBlocks(), mSourcePropertyCount(0), mSourceSignature(0),
+      mPreserveFormatting(true), mGeneration(NextGeneration())
+{
+}
+
+BgeConfig::BgeConfig(const BgeConfig& other)
+    : mProperties(other.mProperties), mSections(other.mSections), mSectionHashes(other.mSectionHashes), mPath(other.mPath),
+      mExactSubscribers(), mPrefixSubscribers(), mNextSubscriptionId(0), mJournal(), mCompaction(), mSource(other.mSource),
+      mSourceId(other.mSourceId), mSourceBlocks(other.mSourceBlocks), mSourcePropertyCount(other.mSourcePropertyCount),
+      mSourceSignature(other.mSourceSignature), mPreserveFormatting(other.mPreserveFormatting), mGeneration(NextGeneration())
+{
+}
+
+BgeConfig& BgeConfig::operator=(const BgeConfig& other)
+{
+    if (this == &other)
+        return *this;
+
+    mProperties = other.mProperties;
+    mSections = other.mSections;
+    mSectionHashes = other.mSectionHashes;
+    mPath = other.mPath;
+    mGeneration = NextGeneration();
+    mSource = other.mSource;
+    mSourceId = other.mSourceId;
+    mSourceBlocks = other.mSourceBlocks;
+    mSourcePropertyCount = other.mSourcePropertyCount;
+    mSourceSignature = other.mSourceSignature;
+    mPreserveFormatting = other.mPreserveFormatting;
+    return *this;
+}
+
+void BgeConfig::Close()
+{
+    mGeneration = NextGeneration();
+    mProperties.clear();
+    mSections.clear();
+    mSectionHashes.clear();
+    mSource.clear();
+    mSourceId = 0;
+    mSourceBlocks.clear();
+    mSourcePropertyCount = 0;
+    mSourceSignature = 0;
+}
+
+bool BgeConfig::Open(std::string path)
+{
+    std::string text;
+    if (!ReadText(path, text))
+        return false;
+
+    Close();
+
+    // a journal that is still open belongs to the previous file
+    if (mJournal != nullptr && path != mPath)
+        mJournal = std::unique_ptr<BgeFile>(new BgeFile(GetJournalPath(path), true, BgeFileFlags::APPEND));
+
+    mPath = path;
+    Load(std::move(text));
+    ReplayJournals();
+    return true;
+}
+
+std::vector<std::unique_ptr<BgeConfig>> BgeConfig::OpenMany(std::vector<std::string> paths, size_t threadCount)
+{
+    std::vector<std::unique_ptr<BgeConfig>> configs = std::vector<std::unique_ptr<BgeConfig>>(paths.size());
+    if (threadCount == 0)
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+
+    ForEachParallel(paths.size(), threadCount, [&paths, &configs](size_t index){
+        std::unique_ptr<BgeConfig> config = std::unique_ptr<BgeConfig>(new BgeConfig());
+        if (config->Open(paths[index]))
+            configs[index] = std::move(config);
+    });
+
+    return configs;
+}
+
+bool BgeConfig::OpenMany(std::vector<BgeConfigMergeEntry> files, size_t threadCount)
+{
+    std::vector<BgeConfig> configs = std::vector<BgeConfig>(files.size());
+    std::unique_ptr<bool[]> opened = std::unique_ptr<bool[]>(new bool[files.size()]);
+    if (threadCount == 0)
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+
+    // the merged configuration gets written from scratch anyway, so no text has to be kept
+    ForEachParallel(files.size(), threadCount, [&files, &configs, &opened](size_t index){
+        configs[index].SetPreserveFormatting(false);
+        opened[index] = configs[index].Open(files[index].Path);
+    });
+
+    Close();
+    DisableJournal();
+    mPath.clear();
+
+    bool result = true;
+    for (size_t i = 0; i < files.size(); i++)
+    {
+        result = result && opened[i];
+        if (!opened[i])
+            continue;
+
+        BgeConfig& config = configs[i];
+        if (files[i].Prefix.empty())
+        {
+            for (auto& property : config.mProperties)
+                InsertProperty(property.Name, property);
+
+            for (auto& section : config.mSections)
+                MergeSection(*AddSection(section.Name), section);
+
+            continue;
+        }
+
+        BgeConfigSection* target = AddSection(files[i].Prefix);
+        if (target == nullptr)
+            continue;
+
+        for (auto& property : config.mProperties)
+            target->AddProperty(property.Name, property);
+
+        for (auto& section : config.mSections)
+            MergeSection(*target->AddSubSection(section.Name), section);
+    }
+
+    return result;
+}
+
+void BgeConfig::OpenFromMemory(std::string_view text)
+{
+    Close();
+    DisableJournal();
+    mPath.clear();
+
+    if (mPreserveFormatting)
+        Load(std::string(text));
+    else
+        LoadText(text);
+}
+
+bool BgeConfig::OpenFromFile(BgeFile& file, uint64_t offset, size_t length)
+{
+    if (!file.Ready() || file.IsWriter())
+    {
+        BGE_LOG("Could not read configuration from file \"%s\": File not opened for reading\n", file.GetPath().c_str());
+        return false;
+    }
+
+    if (offset > file.Size() || length > file.Size() - offset)
+    {
+        BGE_LOG("Could not read configuration from file \"%s\": Range %llu+%zu is out of bounds\n", file.GetPath().c_str(), (unsigned long long)offset, length);
+        return false;
+    }
+
+    std::string text = std::string(length, '\0');
+    file.SeekTo(offset);
+    if (length != 0)
+        file.Read(&text[0], sizeof(char), length);
+
+    // the file could have shrunk in the meantime, the rest of the text would be zeros
+    if (length != 0 && file.EndOfFile())
+    {
+        BGE_LOG("Could not read configuration from file \"%s\": Only part of the range %llu+%zu could be read\n", file.GetPath().c_str(), (unsigned long long)offset, length);
+        return false;
+    }
+
+    Close();
+    DisableJournal();
+    mPath.clear();
+    Load(std::move(text));
+    return true;
+}
+
+bool BgeConfig::Parse(std::string path, BgeConfigVisitor& visitor)
+{
+    BgeFile file = BgeFile(path, false);
+    if (!file.Ready())
+        return false;
+
+    std::vector<char> buffer = std::vector<char>(BGE_CONFIG_PARSE_CHUNK);
+    std::string fullName;
+    size_t sectionLength = 0;
+
+    // `length` bytes at the front of the buffer are waiting to be scanned
+    uint64_t remaining = file.Size();
+    size_t length = 0;
+
+    // a bulk import is read exactly once
+    bool streaming = BGE_FILE_SEQUENTIAL_HINT != 0 && file.Size() >= BGE_FILE_SEQUENTIAL_HINT;
+    if (streaming)
+        file.Advise(BgeIoAdvice::SEQUENTIAL);
+
+    while (true)
+    {
+        size_t count = (size_t)std::min<uint64_t>(remaining, buffer.size() - length);
+        if (count != 0)
+            file.Read(&buffer[length], sizeof(char), count);
+
+        if (streaming && count != 0)
+            file.Advise(BgeIoAdvice::DONTNEED, file.GetCursor() - count, count);
+
+        remaining -= count;
+        length += count;
+
+        std::string_view text = std::string_view(buffer.data(), length);
+        size_t lineBegin = 0;
+
+        for (size_t lineEnd = text.find('\n'); lineEnd != std::string_view::npos; lineEnd = text.find('\n', lineBegin))
+        {
+            VisitLine(text.substr(lineBegin, lineEnd - lineBegin), visitor, fullName, sectionLength);
+            lineBegin = lineEnd + 1;
+        }
+
+        if (remaining == 0)
+        {
+            if (lineBegin < length)
+                VisitLine(text.substr(lineBegin), visitor, fullName, sectionLength);
+            break;
+        }
+
+        // a single line doesn't fit into the buffer, so it has to grow
+        if (lineBegin == 0)
+        {
+            buffer.resize(buffer.size() * 2);
+            continue;
+        }
+
+        // keep the unfinished line for the next chunk
+        memmove(buffer.data(), buffer.data() + lineBegin, length - lineBegin);
+        length -= lineBegin;
+    }
+
+    file.Close();
+    return true;
+}
+
+void BgeConfig::ParseFromMemory(std::string_view text, BgeConfigVisitor& visitor)
+{
+    std::string fullName;
+    size_t sectionLength = 0;
+
+    while (!text.empty())
+    {
+        size_t lineEnd = text.find('\n');
+        VisitLine(text.substr(0, lineEnd), visitor, fullName, sectionLength);
+        text = (lineEnd == std::string_view::npos) ? std::string_view() : text.substr(lineEnd+1);
+    }
+}
+
+bool BgeConfig::Reload()
+{
+    if (mPath.empty())
+        return false;
+
+    std::string text;
+    if (!ReadText(mPath, text))
+        return false;
+
+    mGeneration = NextGeneration();
+
+    std::vector<SectionBlock> blocks;
+    SectionHashMap hashes;
+    SplitBlocks(text, blocks, hashes);
+
+    // anything that changes the layout of the tree can't be patched in place
+    bool fullReload = hashes.size() != mSectionHashes.size();
+    for (auto& entry : hashes)
+    {
+        if (fullReload)
+            break;
+
+        auto previous = mSectionHashes.find(entry.first);
+        if (previous == mSectionHashes.end())
+        {
+            fullReload = true;
+            break;
+        }
+
+        if (previous->second.Hash == entry.second.Hash)
+            continue;
+
+        fullReload = entry.second.BlockCount != 1 || previous->second.BlockCount != 1 ||
+                     entry.second.NestedNames || previous->second.NestedNames;
+    }
+
+    bool notify = !mExactSubscribers.empty() || !mPrefixSubscribers.empty();
+    BgeConfigDifferenceList changes;
+
+    if (fullReload)
+    {
+        BgeConfigPropertyList previousProperties = std::move(mProperties);
+        BgeConfigSectionList previousSections = std::move(mSections);
+
+        Close();
+        Load(std::move(text));
+        ReplayJournals();
+
+        if (notify)
+        {
+            DiffProperties(previousProperties, mProperties, "", changes);
+            DiffSections(previousSections, mSections, "", changes);
+            NotifyChanges(changes);
+        }
+        return true;
+    }
+
+    // the text of unchanged blocks is still the same, it just moved
+    uint64_t previousSourceId = mSourceId;
+    if (mSourceId != 0)
+    {
+        uint64_t sourceId = NextSourceId();
+        RebaseSource(blocks, hashes, sourceId);
+        mSource = std::move(text);
+        mSourceId = sourceId;
+        mSourceBlocks = blocks;
+    }
+    std::string_view source = (mSourceId != 0) ? std::string_view(mSource) : std::string_view(text);
+
+    // the properties of every reparsed block, from before it was reparsed
+    std::vector<std::pair<std::string, BgeConfigPropertyList>> reparsed;
+
+    for (auto& block : blocks)
+    {
+        if (mSectionHashes[block.Name].Hash == hashes[block.Name].Hash)
+            continue;
+
+        BgeConfigSection* section = block.Name.empty() ? nullptr : GetSection(block.Name);
+        BgeConfigPropertyList& properties = (section != nullptr) ? section->GetProperties() : mProperties;
+        BgeConfigPropertyList previousProperties = std::move(properties);
+        properties.clear();
+
+        LoadBlock(source.substr(block.Begin, block.End - block.Begin), section);
+
+        // an emptied block doesn't add any property that would invalidate the hash
+        if (section != nullptr)
+            section->InvalidateHash();
+
+        if (mSourceId != 0)
+        {
+            for (auto& property : previousProperties)
+                mSourcePropertyCount -= (property.mSourceId == previousSourceId) ? 1 : 0;
+            mSourcePropertyCount += CountSourcedProperties(properties);
+        }
+
+        if (notify)
+            reparsed.emplace_back(block.Name, std::move(previousProperties));
+    }
+
+    mSectionHashes = std::move(hashes);
+
+    // reparsed blocks lost the journaled changes, everything else still has them
+    ReplayJournals();
+
+    if (notify)
+    {
+        // replaying may add sections, so they are looked up again
+        for (auto& block : reparsed)
+        {
+            BgeConfigSection* section = block.first.empty() ? nullptr : GetSection(block.first);
+            DiffProperties(block.second, (section != nullptr) ? section->GetProperties() : mProperties, block.first, changes);
+        }
+        NotifyChanges(changes);
+    }
+    return true;
+}
+
+std::string BgeConfig::GetPath()
+{
+    return mPath;
+}
+
+uint64_t BgeConfig::GetGeneration()
+{
+    return mGeneration;
+}
+
+size_t BgeConfig::OnChange(std::string pattern, BgeConfigChangeCallback callback)
+{
+    size_t id = ++mNextSubscriptionId;
+
+    if (pattern == "*")
+        mPrefixSubscribers[""].push_back(ChangeSubscription{id, callback});
+    else if (pattern.size() > 2 && pattern.compare(pattern.size() - 2, 2, ".*") == 0)
+        mPrefixSubscribers[pattern.substr(0, pattern.size() - 2)].push_back(ChangeSubscription{id, callback});
+    else
+        mExactSubscribers[pattern].push_back(ChangeSubscription{id, callback});
+
+    return id;
+}
+
+void BgeConfig::RemoveOnChange(size_t id)
+{
+    for (ChangeSubscriberMap* subscriberMap : { &mExactSubscribers, &mPrefixSubscribers })
+    {
+        for (auto entry = subscriberMap->begin(); entry != subscriberMap->end(); entry++)
+        {
+            auto& subscriptions = entry->second;
+            auto subscription = std::find_if(subscriptions.begin(), subscriptions.end(), [id](ChangeSubscription& other){ return other.Id == id; });
+            if (subscription == subscriptions.end())
+                continue;
+
+            subscriptions.erase(subscription);
+            if (subscriptions.empty())
+                subscriberMap->erase(entry);
+            return;
+        }
+    }
+}
+
+void BgeConfig::Save(std::string path, size_t threadCount)
+{
+    bool ownFile = !mPath.empty() && path == mPath;
+
+    // a running compaction writes the same file
+    if (ownFile && mCompaction.valid())
+        mCompaction.wait();
+
+    if (!SaveFile(path, threadCount) || !ownFile)
+        return;
+
+    // everything the journal recorded is part of the file now
+    std::string journalPath = GetJournalPath(mPath);
+    bool journaling = mJournal != nullptr;
+    mJournal = nullptr;
+    remove((journalPath + ".old").c_str());
+    remove(journalPath.c_str());
+    if (journaling)
+        EnableJournal();
+}
+
+void BgeConfig::SetPreserveFormatting(bool preserve)
+{
+    mPreserveFormatting = preserve;
+    if (preserve)
+        return;
+
+    mSource.clear();
+    mSource.shrink_to_fit();
+    mSourceId = 0;
+    mSourceBlocks.clear();
+}
+
+bool BgeConfig::EnableJournal()
+{
+    if (mPath.empty())
+        return false;
+
+    if (mJournal == nullptr)
+        mJournal = std::unique_ptr<BgeFile>(new BgeFile(GetJournalPath(mPath), true, BgeFileFlags::APPEND));
+
+    if (mJournal->Ready())
+        return true;
+
+    mJournal = nullptr;
+    return false;
+}
+
+void BgeConfig::DisableJournal()
+{
+    mJournal = nullptr;
+}
+
+std::shared_future<bool> BgeConfig::Compact()
+{
+    if (mCompaction.valid())
+        mCompaction.wait();
+
+    std::string journalPath = GetJournalPath(mPath);
+    std::string oldJournalPath = journalPath + ".old";
+
+    // the journal of an interrupted compaction can't be rotated away, so we fold it right here
+    if (mPath.empty() || FileExists(oldJournalPath))
+    {
+        std::promise<bool> result;
+        if (!mPath.empty())
+            Save(mPath);
+
+        result.set_value(!mPath.empty() && !FileExists(oldJournalPath));
+        mCompaction = result.get_future().share();
+        return mCompaction;
+    }
+
+    // from now on changes go into a new journal, the rotated one is removed once the file is saved
+    bool journaling = mJournal != nullptr;
+    mJournal = nullptr;
+    rename(journalPath.c_str(), oldJournalPath.c_str());
+    if (journaling)
+        EnableJournal();
+
+    std::shared_ptr<BgeConfig> snapshot = std::make_shared<BgeConfig>(*this);
+    std::string path = mPath;
+
+    mCompaction = std::async(std::launch::async, [snapshot, path, oldJournalPath](){
+        if (!snapshot->SaveFile(path, 0))
+            return false;
+
+        remove(oldJournalPath.c_str());
+        return true;
+    }).share();
+    return mCompaction;
+}
+
+void BgeConfig::Set(std::string name, int value)
+{
+    SetProperty(name, BgeConfigProperty(BgePropertyValueType::INT, name, "", value));
+}
+
+void BgeConfig::Set(std::string name, float value)
+{
+    SetProperty(name, BgeConfigProperty(BgePropertyValueType::FLOAT, name, "", 0, value));
+}
+
+void BgeConfig::Set(std::string name, bool value)
+{
+    SetProperty(name, BgeConfigProperty(BgePropertyValueType::BOOL, name, "", 0, 0.f, value));
+}
+
+void BgeConfig::Set(std::string name, std::string value)
+{
+    SetProperty(name, BgeConfigProperty(BgePropertyValueType::STRING, name, value));
+}
+
+void BgeConfig::Set(std::string name, const char* value)
+{
+    Set(name, std::string(value));
+}
+
+bool BgeConfig::SaveFile(std::string path, size_t threadCount)
+{
+    // a crash while saving must never leave a half-written configuration behind
+    BgeFile file = BgeFile(path, true, BgeFileFlags::ATOMIC);
+    if (!file.Ready())
+        return false;
+
+    // spinning up threads only pays off for big configurations
+    if (threadCount == 0)
+        threadCount = (CountProperties(mSections) < 16384) ? 1 : std::max(1u, std::thread::hardware_concurrency());
+    threadCount = std::min(threadCount, mSections.size());
+
+    // the text that was loaded is about as big as the one that gets saved
+    if (!mSource.empty())
+        file.Reserve(mSource.size());
+
+    BgeConfigEmitter emitter = BgeConfigEmitter(&file);
+    std::string sectionPrefix;
+
+    std::vector<SourceEdit> edits;
+    if (CollectSourceEdits(edits))
+    {
+        SaveSource(emitter, edits);
+        emitter.Flush();
+        return file.Close();
+    }
+
+    for (auto& property : mProperties)
+        property.Save(emitter);
+
+    if (mProperties.size())
+        emitter.Append('\n');
+
+    if (threadCount > 1)
+        SaveSectionsParallel(emitter, threadCount);
+    else
+        for (auto& section : mSections)
+            section.Save(emitter, sectionPrefix);
+
+    emitter.Flush();
+    return file.Close();
+}
+
+void BgeConfig::AddProperty(std::string name, BgeConfigProperty& property)
+{
+    if (InsertProperty(name, property) && mJournal != nullptr)
+        WriteJournalRecord(name, property);
+}
+
+bool BgeConfig::InsertProperty(std::string name, BgeConfigProperty& property)
+{
+    if (name.empty())
+        return false;
+
+    if (HasProperty(name))
+        return false;
+    
+    size_t sectionDivider = name.find_first_of('.');
+    if (sectionDivider == std::string::npos)
+    {
+        property.Name = name;
+        property.SetParent(nullptr);
+        mProperties.push_back(property);
+        mGeneration = NextGeneration();
+        return true;
+    }
+
+    std::string sectionName = name.substr(0, sectionDivider);
+    std::string nextSectionStr = name.substr(sectionDivider+1);
+
+    BgeConfigSection* nextSection = nullptr;
+    if (!HasSection(sectionName))
+        nextSection = AddSection(sectionName);
+    else
+        nextSection = GetSection(sectionName);
+
+    if (nextSection == nullptr)
+        return false;
+
+    nextSection->AddProperty(nextSectionStr, property);
+    mGeneration = NextGeneration();
+    return true;
+}
+
+void BgeConfig::ApplyProperty(std::string name, BgeConfigProperty& property)
+{
+    BgeConfigProperty* existing = Get(name);
+    if (existing == nullptr)
+    {
+        InsertProperty(name, property);
+        return;
+    }
+
+    existing->Type = property.Type;
+    existing->StrValue = property.StrValue;
+    existing->IntValue = property.IntValue;
+    existing->FloatValue = property.FloatValue;
+    existing->BoolValue = property.BoolValue;
+
+    if (existing->GetParent() != nullptr)
+        existing->GetParent()->InvalidateHash();
+}
+
+void BgeConfig::SetProperty(std::string name, BgeConfigProperty property)
+{
+    ApplyProperty(name, property);
+
+    if (mJournal != nullptr)
+        WriteJournalRecord(name, property);
+}
+
+void BgeConfig::WriteJournalRecord(std::string& name, BgeConfigProperty& property)
+{
+    mJournal->Write<uint8_t>((uint8_t)property.Type);
+    mJournal->WriteString(name);
+
+    switch(property.Type)
+    {
+        case BgePropertyValueType::INT:
+            mJournal->Write<int32_t>(property.IntValue);
+            break;
+
+        case BgePropertyValueType::FLOAT:
+            mJournal->Write<float>(property.FloatValue);
+            break;
+
+        case BgePropertyValueType::BOOL:
+            mJournal->Write(property.BoolValue);
+            break;
+
+        default:
+        case BgePropertyValueType::UNKNOWN:
+        case BgePropertyValueType::STRING:
+            mJournal->WriteString(property.StrValue);
+            break;
+    }
+
+    // a record only helps if it is out of our process before we crash
+    mJournal->Flush();
+}
+
+bool BgeConfig::ReplayJournal(std::string path)
+{
+    if (!FileExists(path))
+        return false;
+
+    BgeFile file = BgeFile(path, false);
+    if (!file.Ready())
+        return false;
+
+    while (file.GetCursor() < file.Size())
+    {
+        BgeConfigProperty property = BgeConfigProperty((BgePropertyValueType)file.Read<uint8_t>());
+        std::string name = file.ReadString();
+
+        switch(property.Type)
+        {
+            case BgePropertyValueType::INT:
+                property.IntValue = file.Read<int32_t>();
+                break;
+
+            case BgePropertyValueType::FLOAT:
+                property.FloatValue = file.Read<float>();
+                break;
+
+            case BgePropertyValueType::BOOL:
+                property.BoolValue = file.Read();
+                break;
+
+            case BgePropertyValueType::UNKNOWN:
+            case BgePropertyValueType::STRING:
+                property.StrValue = file.ReadString();
+                break;
+
+            default:
+                file.Close();
+                return true;
+        }
+
+        if (file.EndOfFile())
+            break;
+
+        ApplyProperty(name, property);
+    }
+
+    file.Close();
+    return true;
+}
+
+bool BgeConfig::ReplayJournals()
+{
+    std::string journalPath = GetJournalPath(mPath);
+
+    // an unfinished compaction's journal is older than the current one
+    bool replayed = ReplayJournal(journalPath + ".old");
+    replayed = ReplayJournal(journalPath) || replayed;
+    return replayed;
+}
+
+std::string BgeConfig::GetJournalPath(std::string path)
+{
+    return path + ".journal";
+}
+
+bool BgeConfig::FileExists(std::string path)
+{
+    FILE* handle = fopen(path.c_str(), "rb");
+    if (handle == nullptr)
+        return false;
+
+    fclose(handle);
+    return true;
+}
+
+BgeConfigSection* BgeConfig::AddSection(std::string name)
+{
+    if (name.empty())
+        return nullptr;
+
+    if (HasSection(name))
+        return GetSection(name);
+
+    size_t sectionDivider = name.find_first_of('.');
+    if (sectionDivider == std::string::npos)
+    {
+        BgeConfigSection section = BgeConfigSection(name);
+        section.SetParent(nullptr);
+        mSections.push_back(section);
+        mGeneration = NextGeneration();
+        return &mSections.back();
+    }
+
+    std::string sectionName = name.substr(0, sectionDivider);
+    std::string nextSectionName = name.substr(sectionDivider+1);
+
+    return AddSection(sectionName)->AddSubSection(nextSectionName);
+}
+
+bool BgeConfig::HasProperty(std::string name) const
+{
+    if (name.empty())
+        return false;
+
+    size_t sectionDivider = name.find_first_of('.');
+    if (sectionDivider == std::string::npos)
+        return GetPropertyIterator(name) != mProperties.end();
+
+    std::string sectionName = name.substr(0, sectionDivider);
+    std::string nextSectionName = name.substr(sectionDivider+1);
+
+    if (!HasSection(sectionName))
+        return false;
+    
+    return GetSection(sectionName)->HasProperty(nextSectionName);
+}
+
+bool BgeConfig::HasSection(std::string name) const
 {
-    if (!mParent)
-        return Name;
+    if (name.empty())
+        return false;
 
-    return std::string(mParent->GetFullName()).append(".").append(Name);
+    size_t sectionDivider = name.find_first_of('.');
+    if (sectionDivider == std::string::npos)
+        return GetSectionIterator(name) != mSections.end();
+    
+    std::string sectionName = name.substr(0, sectionDivider);
+    std::string nextSectionName = name.substr(sectionDivider+1);
+
+    if (!HasSection(sectionName))
+        return false;
+    
+    return GetSection(sectionName)->HasSubSection(nextSectionName);
 }
 
-void BgeConfigProperty::Save(BgeFile& file)
+BgeConfigProperty* BgeConfig::Get(std::string name)
 {
-    std::string output = std::string(Name).append(" = ");
-    switch(Type)
+    if (name.empty())
+        return nullptr;
+
+    size_t sectionDivider = name.find_first_of('.');
+    if (sectionDivider == std::string::npos)
     {
-        case BgePropertyValueType::INT:
-            output.append(std::to_string(IntValue));
-            break;
+        auto propertyIterator = GetPropertyIterator(name);
+        return (propertyIterator == mProperties.end()) ? nullptr : &*propertyIterator;
+    }
 
-        case BgePropertyValueType::FLOAT:
-            output.append(std::to_string(FloatValue));
-            break;
-        
-        case BgePropertyValueType::BOOL:
-        {
-            BoolValue ? output.append("true") : output.append("false");
-            break;
-        }
+    std::string sectionName = name.substr(0, sectionDivider);
+    std::string nextSectionName = name.substr(sectionDivider+1);
 
-        default:
-        case BgePropertyValueType::UNKNOWN:
-        case BgePropertyValueType::STRING:
-            output.append(StrValue);
-            break;
+    if (!HasSection(sectionName))
+        return nullptr;
+
+    return GetSection(sectionName)->Get(nextSectionName);
+}
+
+BgeConfigSection* BgeConfig::GetSection(std::string name)
+{
+    if (name.empty())
+        return nullptr;
+
+    size_t sectionDivider = name.find_first_of('.');
+    if (sectionDivider == std::string::npos)
+    {
+        auto sectionIterator = GetSectionIterator(name);
+        return (sectionIterator == mSections.end()) ? nullptr : &*sectionIterator;
     }
 
-    file.WriteLine(output);
+    std::string sectionName = name.substr(0, sectionDivider);
+    std::string nextSectionName = name.substr(sectionDivider+1);
+
+    if (!HasSection(sectionName))
+        return nullptr;
+
+    return GetSection(sectionName)->GetSubSection(nextSectionName);
 }
 
-bool BgeConfigProperty::operator==(BgeConfigProperty& other)
+BgeConfigPropertyList& BgeConfig::GetProperties()
 {
-    return Type == other.Type && Name == other.Name; // it is enough if the name and type are the same
+    return mProperties;
 }
 
-bool BgeConfigProperty::operator!=(BgeConfigProperty& other)
+BgeConfigSectionList& BgeConfig::GetSections()
 {
-    return !operator==(other);
+    return mSections;
 }
 
-void BgeConfigProperty::SetParent(BgeConfigSection* parent)
+const BgeConfigPropertyList& BgeConfig::GetProperties() const
 {
-    mParent = parent;
+    return mProperties;
 }
 
-////////////////////////
-/// BgeConfigSection ///
-////////////////////////
+const BgeConfigSectionList& BgeConfig::GetSections() const
+{
+    return mSections;
+}
 
-BgeConfigSection::BgeConfigSection()
-    : Name(), mProperties(), mNestedSections(), mParent(nullptr)
+const BgeConfigProperty* BgeConfig::Get(std::string name) const
 {
+    return const_cast<BgeConfig*>(this)->Get(name);
 }
 
-BgeConfigSection::BgeConfigSection(std::string name)
-    : Name(name), mParent(nullptr)
+const BgeConfigSection* BgeConfig::GetSection(std::string name) const
 {
+    return const_cast<BgeConfig*>(this)->GetSection(name);
 }
 
-std::string BgeConfigSection::GetFullName()
+BgePropertyValueType BgeConfig::EstimateValueType(std::string_view value)
 {
-    if (!mParent)
-        return Name;
+    if (value.empty())
+        return BgePropertyValueType::UNKNOWN;
 
-    return std::string(mParent->GetFullName()).append(".").append(Name);
+    if (StringIsBool(value))
+        return BgePropertyValueType::BOOL;
+
+    if (StringIsNumber(value))
+        return BgePropertyValueType::INT;
+
+    if (StringIsFloat(value))
+        return BgePropertyValueType::FLOAT;
+
+    return BgePropertyValueType::STRING;
 }
 
-void BgeConfigSection::Save(BgeFile& file, std::string sectionPrefix)
+BgeConfigPropertyList::iterator BgeConfig::GetPropertyIterator(std::string name)
 {
-    std::string sectionName = "[";
-    if (!sectionPrefix.empty())
-        sectionName.append(sectionPrefix).append(".");
-    sectionName.append(Name).append("]");
+    return std::find_if(mProperties.begin(), mProperties.end(), [name](BgeConfigProperty& other){ return name == other.Name; });
+}
 
-    file.WriteLine(sectionName);
-    for (auto& property : mProperties)
-        property.Save(file);
-    file.WriteLine();
+BgeConfigPropertyList::const_iterator BgeConfig::GetPropertyIterator(std::string name) const
+{
+    return std::find_if(mProperties.begin(), mProperties.end(), [name](const BgeConfigProperty& other){ return name == other.Name; });
+}
 
-    std::string newSectionPrefix = std::string(sectionPrefix);
-    if (!newSectionPrefix.empty())
-        newSectionPrefix.append(".");
-    newSectionPrefix.append(Name);
+BgeConfigSectionList::iterator BgeConfig::GetSectionIterator(std::string name)
+{
+    return std::find_if(mSections.begin(), mSections.end(), [name](BgeConfigSection& other){ return name == other.Name; });
+}
 
-    for (auto& subSection : mNestedSections)
-        subSection.Save(file, newSectionPrefix);
+BgeConfigSectionList::const_iterator BgeConfig::GetSectionIterator(std::string name) const
+{
+    return std::find_if(mSections.begin(), mSections.end(), [name](const BgeConfigSection& other){ return name == other.Name; });
 }
 
-BgeConfigProperty* BgeConfigSection::Get(std::string name)
+bool BgeConfig::ReadText(std::string path, std::string& text)
 {
-    if (name.empty())
-        return nullptr;
+    BgeFile file = BgeFile(path, false);
+    if (!file.Ready())
+        return false;
 
-    size_t sectionDivider = name.find_first_of('.');
-    if (sectionDivider == std::string::npos)
+    text.resize(file.Size());
+    if (!text.empty())
+        file.Read(&text[0], sizeof(char), text.size());
+
+    file.Close();
+    return true;
+}
+
+void BgeConfig::SaveSectionsParallel(BgeConfigEmitter& emitter, size_t threadCount)
+{
+    // a few runs per thread keep the threads busy even if some sections take longer than others,
+    // without paying for one buffer per section
+    size_t totalProperties = CountProperties(mSections);
+    size_t runCount = std::min(mSections.size(), threadCount * 4);
+    size_t runProperties = totalProperties / runCount + 1;
+
+    // split the sections into runs holding about the same number of properties
+    std::vector<size_t> runBegins = { 0 };
+    size_t properties = 0;
+    for (size_t index = 0; index + 1 < mSections.size(); index++)
     {
-        auto propertyIterator = GetPropertyIterator(name);
-        return (propertyIterator == mProperties.end()) ? nullptr : &*propertyIterator;
+        properties += mSections[index].GetProperties().size() + CountProperties(mSections[index].GetSubSections());
+        if (properties >= runProperties * runBegins.size())
+            runBegins.push_back(index + 1);
     }
+    runBegins.push_back(mSections.size());
 
-    std::string sectionName = name.substr(0, sectionDivider);
-    std::string nextSectionName = name.substr(sectionDivider+1);
+    std::vector<std::unique_ptr<BgeConfigEmitter>> buffers = std::vector<std::unique_ptr<BgeConfigEmitter>>(runBegins.size() - 1);
 
-    if (!HasSubSection(sectionName))
-        return nullptr;
+    ForEachParallel(buffers.size(), threadCount, [this, &buffers, &runBegins](size_t run){
+        std::string sectionPrefix;
 
-    return GetSubSection(sectionName)->Get(nextSectionName);
+        // buffers grow on demand, so they start out small
+        buffers[run] = std::unique_ptr<BgeConfigEmitter>(new BgeConfigEmitter(nullptr, 4096));
+        for (size_t index = runBegins[run]; index < runBegins[run + 1]; index++)
+            mSections[index].Save(*buffers[run], sectionPrefix);
+    });
+
+    // buffers at least as big as the emitter's own one skip it and are written straight to the file,
+    // smaller ones are copied into it
+    for (auto& buffer : buffers)
+        emitter.Append(buffer->View());
 }
 
-BgeConfigSection* BgeConfigSection::GetSubSection(std::string name)
+void BgeConfig::ForEachParallel(size_t count, size_t threadCount, const std::function<void(size_t)>& function)
 {
-    if (name.empty())
-        return nullptr;
+    std::atomic<size_t> nextIndex = 0;
 
-    size_t sectionDivider = name.find_first_of('.');
-    if (sectionDivider == std::string::npos)
+    auto worker = [count, &function, &nextIndex](){
+        for (size_t index = nextIndex++; index < count; index = nextIndex++)
+            function(index);
+    };
+
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < std::min(threadCount, count); i++)
+        workers.emplace_back(worker);
+
+    worker();
+
+    for (auto& thread : workers)
+        thread.join();
+}
+
+void BgeConfig::MergeSection(BgeConfigSection& target, BgeConfigSection& source)
+{
+    for (auto& property : source.GetProperties())
+        target.AddProperty(property.Name, property);
+
+    for (auto& subSection : source.GetSubSections())
+        MergeSection(*target.AddSubSection(subSection.Name), subSection);
+}
+
+size_t BgeConfig::CountProperties(BgeConfigSectionList& sections)
+{
+    size_t count = 0;
+    for (auto& section : sections)
+        count += section.GetProperties().size() + CountProperties(section.GetSubSections());
+    return count;
+}
+
+void BgeConfig::Load(std::string text)
+{
+    if (!mPreserveFormatting)
     {
-        auto sectionIterator = GetSectionIterator(name);
-        return (sectionIterator == mNestedSections.end()) ? nullptr : &*sectionIterator;
+        LoadText(text);
+        return;
     }
 
-    std::string sectionName = name.substr(0, sectionDivider);
-    std::string nextSectionName = name.substr(sectionDivider+1);
+    mSource = std::move(text);
+    mSourceId = NextSourceId();
 
-    if (!HasSubSection(sectionName))
-        return nullptr;
-    
-    return GetSubSection(sectionName)->GetSubSection(nextSectionName);
+    std::string sectionPrefix;
+    mSourceBlocks = LoadText(mSource);
+    mSourcePropertyCount = CountSourcedProperties(mProperties) + CountSourcedProperties(mSections);
+    mSourceSignature = SectionSignature(mSections, sectionPrefix);
 }
 
-bool BgeConfigSection::HasProperty(std::string name)
+std::vector<BgeConfig::SectionBlock> BgeConfig::LoadText(std::string_view text)
 {
-    if (name.empty())
+    std::vector<SectionBlock> blocks;
+    SplitBlocks(text, blocks, mSectionHashes);
+
+    for (auto& block : blocks)
+    {
+        BgeConfigSection* section = block.Name.empty() ? nullptr : AddSection(block.Name);
+        LoadBlock(text.substr(block.Begin, block.End - block.Begin), section);
+    }
+
+    return blocks;
+}
+
+bool BgeConfig::CollectSourceEdits(std::vector<SourceEdit>& edits)
+{
+    if (mSourceId == 0)
         return false;
 
-    size_t sectionDivider = name.find_first_of('.');
-    if (sectionDivider == std::string::npos)
-        return GetPropertyIterator(name) != mProperties.end();
+    std::string sectionPrefix;
+    if (SectionSignature(mSections, sectionPrefix) != mSourceSignature)
+        return false;
 
-    std::string sectionName = name.substr(0, sectionDivider);
-    std::string nextSectionName = name.substr(sectionDivider+1);
+    // properties can be edited through any pointer to them, so every property read from the
+    // text is compared with the value it had there
+    size_t insertedCount = 0;
+    std::vector<BgeConfigPropertyList*> insertLists;
+    auto collect = [&](BgeConfigProperty& property)
+    {
+        if (property.mSourceId == mSourceId)
+        {
+            CollectSourceEdit(property, edits);
+            return;
+        }
 
-    if (!HasSubSection(sectionName))
+        insertedCount++;
+        BgeConfigSection* parent = property.GetParent();
+        insertLists.push_back((parent != nullptr) ? &parent->GetProperties() : &mProperties);
+    };
+
+    for (auto& property : mProperties)
+        collect(property);
+    ForEachProperty(mSections, collect);
+
+    // every property that isn't new has to be from the file, otherwise one of them is gone
+    size_t propertyCount = mProperties.size() + CountProperties(mSections);
+    if (propertyCount - insertedCount != mSourcePropertyCount)
         return false;
-    
-    return GetSubSection(sectionName)->HasProperty(nextSectionName);
+
+    std::sort(insertLists.begin(), insertLists.end());
+    insertLists.erase(std::unique(insertLists.begin(), insertLists.end()), insertLists.end());
+    for (auto properties : insertLists)
+        if (!CollectSourceInserts(*properties, edits))
+            return false;
+
+    std::stable_sort(edits.begin(), edits.end(), [](const SourceEdit& a, const SourceEdit& b){ return a.Begin < b.Begin; });
+    return true;
 }
 
-bool BgeConfigSection::HasSubSection(std::string name)
+void BgeConfig::CollectSourceEdit(BgeConfigProperty& property, std::vector<SourceEdit>& edits)
 {
-    if (name.empty())
-        return false;
+    std::string_view source = mSource;
 
-    size_t sectionDivider = name.find_first_of('.');
-    if (sectionDivider == std::string::npos)
-        return GetSectionIterator(name) != mNestedSections.end();
-    
-    std::string sectionName = name.substr(0, sectionDivider);
-    std::string nextSectionName = name.substr(sectionDivider+1);
+    size_t valueBegin = property.mSourceBegin + property.mSourceValueBegin;
+    size_t valueEnd = property.mSourceBegin + property.mSourceValueEnd;
+    std::string_view value = source.substr(valueBegin, valueEnd - valueBegin);
 
-    if (!HasSubSection(sectionName))
+    char quote = 0;
+    bool stringType = property.Type == BgePropertyValueType::STRING || property.Type == BgePropertyValueType::UNKNOWN;
+    if (stringType && !value.empty() && (value.front() == '"' || value.front() == '\''))
+        quote = value.front();
+
+    // the name in the file may still carry sub-sections ("Sub.Name = 1")
+    size_t equalSignIdx = source.rfind('=', valueBegin - 1);
+    std::string_view sourceName = TrimView(source.substr(property.mSourceBegin, equalSignIdx - property.mSourceBegin));
+    std::string_view namePrefix = sourceName.substr(0, sourceName.size() - std::min(sourceName.size(), property.Name.size()));
+    bool renamed = sourceName.size() < property.Name.size() || sourceName.substr(namePrefix.size()) != property.Name ||
+                   (!namePrefix.empty() && namePrefix.back() != '.');
+
+    if (renamed)
+    {
+        size_t nameDivider = sourceName.find_last_of('.');
+        namePrefix = (nameDivider == std::string_view::npos) ? std::string_view() : sourceName.substr(0, nameDivider + 1);
+        edits.push_back(SourceEdit{property.mSourceBegin, valueEnd, SourceEdit::Kind::LINE, &property, namePrefix, quote});
+    }
+    else if (property.ValueHash() != property.mSourceHash)
+        edits.push_back(SourceEdit{valueBegin, valueEnd, SourceEdit::Kind::VALUE, &property, std::string_view(), quote});
+}
+
+bool BgeConfig::CollectSourceInserts(BgeConfigPropertyList& properties, std::vector<SourceEdit>& edits)
+{
+    std::string_view source = mSource;
+    BgeConfigProperty* anchor = nullptr;
+
+    for (auto& property : properties)
+        if (property.mSourceId == mSourceId && (anchor == nullptr || property.mSourceBegin > anchor->mSourceBegin))
+            anchor = &property;
+
+    // without a line of the same section we don't know where the properties have to go
+    if (anchor == nullptr)
         return false;
-    
-    return GetSubSection(sectionName)->HasSubSection(nextSectionName);
+
+    // new lines go in front of the line break of the anchor, "\r" included
+    size_t lineEnd = anchor->mSourceBegin + anchor->mSourceLineEnd;
+    if (lineEnd > 0 && source[lineEnd - 1] == '\r')
+        lineEnd--;
+
+    size_t lineBegin = source.rfind('\n', anchor->mSourceBegin);
+    lineBegin = (lineBegin == std::string_view::npos) ? 0 : lineBegin + 1;
+    std::string_view indentation = source.substr(lineBegin, anchor->mSourceBegin - lineBegin);
+
+    for (auto& property : properties)
+        if (property.mSourceId != mSourceId)
+            edits.push_back(SourceEdit{lineEnd, lineEnd, SourceEdit::Kind::INSERT, &property, indentation, 0});
+
+    return true;
 }
 
-void BgeConfigSection::AddProperty(std::string name, BgeConfigProperty& property)
+void BgeConfig::SaveSource(BgeConfigEmitter& emitter, std::vector<SourceEdit>& edits)
 {
-    if (name.empty())
-        return;
+    std::string_view source = mSource;
+    size_t cursor = 0;
 
-    if (HasProperty(name))
-        return;
-    
-    size_t sectionDivider = name.find_first_of('.');
-    if (sectionDivider == std::string::npos)
+    // new lines use the same line breaks as the rest of the file
+    size_t firstLineEnd = source.find('\n');
+    std::string_view lineBreak = (firstLineEnd != std::string_view::npos && firstLineEnd > 0 && source[firstLineEnd - 1] == '\r') ? "\r\n" : "\n";
+
+    for (auto& edit : edits)
     {
-        property.Name = name;
-        property.SetParent(this);
-        mProperties.push_back(property);
-        return;
-    }
+        emitter.Append(source.substr(cursor, edit.Begin - cursor));
+        cursor = edit.End;
 
-    std::string sectionName = name.substr(0, sectionDivider);
-    std::string nextSectionStr = name.substr(sectionDivider+1);
+        switch (edit.Type)
+        {
+            case SourceEdit::Kind::INSERT:
+                emitter.Append(lineBreak);
+                [[fallthrough]];
+
+            case SourceEdit::Kind::LINE:
+                emitter.Append(edit.Prefix);
+                emitter.Append(edit.Property->Name);
+                emitter.Append(" = ");
+                break;
 
-    BgeConfigSection* nextSection = nullptr;
-    if (!HasSubSection(sectionName))
-        nextSection = AddSubSection(sectionName);
-    else
-        nextSection = GetSubSection(sectionName);
+            case SourceEdit::Kind::VALUE:
+                // "Name =" without a value has no space in front of the new value yet
+                if (edit.Begin == edit.End)
+                    emitter.Append(' ');
+                break;
+        }
 
-    if (nextSection == nullptr)
-        return;
+        if (edit.Quote != 0)
+            emitter.Append(edit.Quote);
+        edit.Property->SaveValue(emitter);
+        if (edit.Quote != 0)
+            emitter.Append(edit.Quote);
+    }
 
-    nextSection->AddProperty(nextSectionStr, property);
+    emitter.Append(source.substr(cursor));
 }
 
-BgeConfigSection* BgeConfigSection::AddSubSection(std::string name)
+void BgeConfig::RebaseSource(std::vector<SectionBlock>& blocks, SectionHashMap& hashes, uint64_t sourceId)
 {
-    if (name.empty())
-        return nullptr;
+    // the n-th block of an unchanged section simply moved to where the n-th block with that name is now
+    std::unordered_map<std::string, std::vector<size_t>> blockBegins;
+    for (auto& block : blocks)
+        blockBegins[block.Name].push_back(block.Begin);
 
-    if (HasSubSection(name))
-        return GetSubSection(name);
+    std::unordered_map<std::string, size_t> blockIndices;
+    std::vector<int64_t> offsets = std::vector<int64_t>(mSourceBlocks.size());
+    std::vector<bool> moved = std::vector<bool>(mSourceBlocks.size(), false);
 
-    size_t sectionDivider = name.find_first_of('.');
-    if (sectionDivider == std::string::npos)
+    for (size_t i = 0; i < mSourceBlocks.size(); i++)
     {
-        BgeConfigSection section = BgeConfigSection(name);
-        section.SetParent(this);
-        mNestedSections.push_back(section);
-        return &mNestedSections.back();
+        SectionBlock& block = mSourceBlocks[i];
+        size_t blockIndex = blockIndices[block.Name]++;
+
+        auto previous = mSectionHashes.find(block.Name);
+        auto current = hashes.find(block.Name);
+        if (previous == mSectionHashes.end() || current == hashes.end() || previous->second.Hash != current->second.Hash)
+            continue;
+
+        std::vector<size_t>& begins = blockBegins[block.Name];
+        if (blockIndex >= begins.size())
+            continue;
+
+        offsets[i] = (int64_t)begins[blockIndex] - (int64_t)block.Begin;
+        moved[i] = true;
     }
 
-    std::string sectionName = name.substr(0, sectionDivider);
-    std::string nextSectionName = name.substr(sectionDivider+1);
+    auto rebase = [this, &offsets, &moved, sourceId](BgeConfigProperty& property){
+        if (property.mSourceId != mSourceId)
+            return;
 
-    return AddSubSection(sectionName)->AddSubSection(nextSectionName);
+        auto block = std::upper_bound(mSourceBlocks.begin(), mSourceBlocks.end(), property.mSourceBegin, [](size_t offset, const SectionBlock& other){ return offset < other.Begin; });
+        size_t blockIndex = (block - mSourceBlocks.begin()) - 1;
+        if (block == mSourceBlocks.begin() || !moved[blockIndex])
+            return;
+
+        property.mSourceBegin += offsets[blockIndex];
+        property.mSourceId = sourceId;
+    };
+
+    for (auto& property : mProperties)
+        rebase(property);
+    ForEachProperty(mSections, rebase);
 }
 
-BgeConfigPropertyList& BgeConfigSection::GetProperties()
+size_t BgeConfig::CountSourcedProperties(BgeConfigPropertyList& properties)
 {
-    return mProperties;
+    size_t count = 0;
+    for (auto& property : properties)
+        count += (property.mSourceId == mSourceId) ? 1 : 0;
+    return count;
 }
 
-BgeConfigSectionList& BgeConfigSection::GetSubSections()
+size_t BgeConfig::CountSourcedProperties(BgeConfigSectionList& sections)
 {
-    return mNestedSections;
+    size_t count = 0;
+    ForEachProperty(sections, [this, &count](BgeConfigProperty& property){ count += (property.mSourceId == mSourceId) ? 1 : 0; });
+    return count;
 }
 
-bool BgeConfigSection::operator==(BgeConfigSection& other)
+uint64_t BgeConfig::SectionSignature(BgeConfigSectionList& sections, std::string& prefix)
 {
-    return Name == other.Name && mProperties.size() == other.mProperties.size() && mNestedSections.size() == other.mNestedSections.size();
+    uint64_t signature = sections.size();
+    size_t prefixLength = prefix.size();
+
+    for (auto& section : sections)
+    {
+        prefix.append(".").append(section.Name);
+        signature += HashBytes(prefix) + SectionSignature(section.GetSubSections(), prefix);
+        prefix.resize(prefixLength);
+    }
+
+    return signature;
 }
 
-bool BgeConfigSection::operator!=(BgeConfigSection& other)
+void BgeConfig::ForEachProperty(BgeConfigSectionList& sections, const std::function<void(BgeConfigProperty&)>& function)
 {
-    return !operator==(other);
+    for (auto& section : sections)
+    {
+        for (auto& property : section.GetProperties())
+            function(property);
+
+        ForEachProperty(section.GetSubSections(), function);
+    }
 }
 
-void BgeConfigSection::SetParent(BgeConfigSection* parent)
+uint64_t BgeConfig::NextSourceId()
 {
-    mParent = parent;
+    static std::atomic<uint64_t> nextSourceId = 0;
+    return ++nextSourceId;
 }
 
-BgeConfigPropertyList::iterator BgeConfigSection::GetPropertyIterator(std::string name)
+uint64_t BgeConfig::NextGeneration()
 {
-    return std::find_if(mProperties.begin(), mProperties.end(), [name](BgeConfigProperty& other){ return name == other.Name; });
+    static std::atomic<uint64_t> nextGeneration = 0;
+    return ++nextGeneration;
 }
 
-BgeConfigSectionList::iterator BgeConfigSection::GetSectionIterator(std::string name)
+void BgeConfig::LoadBlock(std::string_view text, BgeConfigSection* section)
 {
-    return std::find_if(mNestedSections.begin(), mNestedSections.end(), [name](BgeConfigSection& other){ return name == other.Name; });
-}
+    std::string_view sectionName;
+    BgeConfigProperty property;
 
-/////////////////
-/// BgeConfig ///
-/////////////////
+    // remember where every property came from if the block is part of the kept source text
+    bool keepSource = mSourceId != 0 && text.data() >= mSource.data() && text.data() <= mSource.data() + mSource.size();
 
-BgeConfig::BgeConfig()
-    : mProperties(), mSections()
-{
-}
+    while (!text.empty())
+    {
+        size_t lineEnd = text.find('\n');
+        std::string_view rawLine = text.substr(0, lineEnd);
+        text = (lineEnd == std::string_view::npos) ? std::string_view() : text.substr(lineEnd+1);
 
-void BgeConfig::Close()
-{
-    mProperties.clear();
-    mSections.clear();
+        std::string_view line = CleanLine(rawLine);
+
+        // to ensure we are not trying to parse empty lines or the header of this block
+        if (line.empty() || ParseSectionHeader(line, sectionName))
+            continue;
+
+        if (!ParseProperty(line, property))
+            continue;
+
+        if (keepSource)
+        {
+            size_t equalSignIdx = line.find_last_of('=');
+            std::string_view value = TrimView(line.substr(equalSignIdx+1));
+            size_t valueBegin = value.empty() ? equalSignIdx+1 : value.data() - line.data();
+
+            property.mSourceBegin = line.data() - mSource.data();
+            property.mSourceValueBegin = (uint32_t)valueBegin;
+            property.mSourceValueEnd = (uint32_t)(valueBegin + value.size());
+            property.mSourceLineEnd = (uint32_t)(rawLine.data() + rawLine.size() - line.data());
+            property.mSourceHash = property.ValueHash();
+            property.mSourceId = mSourceId;
+        }
+
+        if (section != nullptr)
+            section->AddProperty(property.Name, property);
+        else
+            InsertProperty(property.Name, property);
+    }
 }
 
-void BgeConfig::Open(std::string path)
+void BgeConfig::SplitBlocks(std::string_view text, std::vector<SectionBlock>& blocks, SectionHashMap& hashes)
 {
-    BgeFile file = BgeFile(path, false);
-    if (!file.Ready())
-        return;
+    std::string_view sectionName;
+    size_t lineBegin = 0;
 
-    Close();
+    blocks.clear();
+    hashes.clear();
+    blocks.push_back(SectionBlock{"", 0, 0});
 
-    std::string line;
-    std::string cleanLine;
-    std::string sectionName;
-    std::string split0, split1;
-    BgeConfigSection* currentSection = nullptr;
+    auto closeBlock = [&blocks, &hashes, &text](size_t end){
+        SectionBlock& block = blocks.back();
+        block.End = end;
 
-    while (!file.EndOfFile())
-    {
-        line = file.ReadLine();
+        auto entry = hashes.find(block.Name);
+        if (entry == hashes.end())
+            entry = hashes.emplace(block.Name, SectionHash{HashBytes(""), 0, false}).first;
 
-        // to ensure we are not trying to parse empty lines
-        if (line.length() < 1)
-            continue;
+        entry->second.Hash = HashBytes(text.substr(block.Begin, block.End - block.Begin), entry->second.Hash);
+        entry->second.BlockCount++;
+    };
 
-        // if the line starts with "//" it is a comment and should be ignored
-        if (line.substr(0, 2) == "//")
-            continue;
+    while (lineBegin < text.size())
+    {
+        size_t lineEnd = text.find('\n', lineBegin);
+        if (lineEnd == std::string_view::npos)
+            lineEnd = text.size();
 
-        // remove any whitespaces at the front or end
-        cleanLine = StringTrimComment(line);
-        cleanLine = StringTrimLeading(cleanLine);
+        std::string_view line = CleanLine(text.substr(lineBegin, lineEnd - lineBegin));
 
-        // check if this is a section name or a section end
-        if (cleanLine.at(0) == '[' && cleanLine.at(cleanLine.length()-1) == ']')
+        if (ParseSectionHeader(line, sectionName))
         {
-            sectionName = cleanLine.substr(1, cleanLine.length()-2);
-
-            if (!HasSection(sectionName))
-                currentSection = AddSection(sectionName);
-            else
-                currentSection = GetSection(sectionName);
-            continue;
+            closeBlock(lineBegin);
+            blocks.push_back(SectionBlock{std::string(sectionName), lineBegin, 0});
         }
-
-        if (cleanLine == "[SECTIONEND]")
+        else
         {
-            currentSection = nullptr;
-            sectionName = "";
-            continue;
+            size_t equalSignIdx = line.find_last_of('=');
+            if (equalSignIdx != std::string_view::npos && line.substr(0, equalSignIdx).find('.') != std::string_view::npos)
+                hashes[blocks.back().Name].NestedNames = true;
         }
 
-        // split line
+        lineBegin = lineEnd + 1;
+    }
 
-        size_t equalSignIdx = cleanLine.find_last_of('=');
-        if (equalSignIdx == std::string::npos)
-            continue;
+    closeBlock(text.size());
 
-        split0 = StringTrimLeading(cleanLine.substr(0, equalSignIdx));
-        split1 = StringTrimLeading(cleanLine.substr(equalSignIdx+1, cleanLine.length()-equalSignIdx-1));
+    // an empty global block only exists to simplify the loop above
+    if (blocks.front().End == 0 && blocks.size() > 1)
+    {
+        blocks.erase(blocks.begin());
+        if (--hashes[""].BlockCount == 0)
+            hashes.erase("");
+    }
+}
 
-        BgePropertyValueType estimateType = EstimateValueType(split1);
-        BgeConfigProperty property = BgeConfigProperty();
-        switch(estimateType)
-        {
-            case BgePropertyValueType::INT:
-                property = BgeConfigProperty(estimateType, split0, split1, std::stoi(split1));
-                break;
+bool BgeConfig::ParseProperty(std::string_view line, BgeConfigProperty& property)
+{
+    // split line
+    size_t equalSignIdx = line.find_last_of('=');
+    if (equalSignIdx == std::string_view::npos)
+        return false;
 
-            case BgePropertyValueType::FLOAT:
-                property = BgeConfigProperty(estimateType, split0, split1, 0, std::stod(split1), false);
-                break;
+    BgePropertyValueType estimateType;
+    std::string split0 = std::string(TrimView(line.substr(0, equalSignIdx)));
+    std::string split1 = std::string(ParseValue(TrimView(line.substr(equalSignIdx+1)), estimateType));
 
-            case BgePropertyValueType::BOOL:
-            {
-                bool value = split1 == "true" || split1 == "True" || split1 == "1";
-                property = BgeConfigProperty(estimateType, split0, split1, 0, 0.0, value);
-                break;
-            }
+    switch(estimateType)
+    {
+        case BgePropertyValueType::INT:
+            property = BgeConfigProperty(estimateType, split0, split1, std::stoi(split1));
+            break;
 
-            default:
-            case BgePropertyValueType::UNKNOWN:
-            case BgePropertyValueType::STRING:
-                if (!split1.empty())
-                {
-                    if (split1.at(0) == '\'' || split1.at(0) == '"')
-                        split1 = split1.substr(1);
-
-                    size_t split1EndIdx = split1.length() - 1;
-                    if (split1.at(split1EndIdx) == '\'' || split1.at(split1EndIdx) == '"')
-                        split1 = split1.substr(0, split1EndIdx);
-                }
-                property = BgeConfigProperty(estimateType, split0, split1);
-                break;
+        case BgePropertyValueType::FLOAT:
+            property = BgeConfigProperty(estimateType, split0, split1, 0, StringToFloat(split1), false);
+            break;
+
+        case BgePropertyValueType::BOOL:
+        {
+            bool value = split1 == "true" || split1 == "True" || split1 == "1";
+            property = BgeConfigProperty(estimateType, split0, split1, 0, 0.0, value);
+            break;
         }
-        if (currentSection != nullptr)
-            currentSection->AddProperty(property.Name, property);
-        else
-            AddProperty(property.Name, property);
+
+        default:
+        case BgePropertyValueType::UNKNOWN:
+        case BgePropertyValueType::STRING:
+            property = BgeConfigProperty(estimateType, split0, split1);
+            break;
     }
 
-    file.Close();
+    return true;
 }
 
-void BgeConfig::Save(std::string path)
+std::string_view BgeConfig::ParseValue(std::string_view value, BgePropertyValueType& type)
 {
-    BgeFile file = BgeFile(path, true);
-    if (!file.Ready())
-        return;
-    
-    for (auto& property : mProperties)
-        property.Save(file);
+    type = EstimateValueType(value);
+    if (type != BgePropertyValueType::STRING || value.empty())
+        return value;
 
-    if (mProperties.size())
-        file.WriteLine();
+    if (value.front() == '\'' || value.front() == '"')
+        value.remove_prefix(1);
 
-    for (auto& section : mSections)
-        section.Save(file);
+    if (!value.empty() && (value.back() == '\'' || value.back() == '"'))
+        value.remove_suffix(1);
 
-    file.Close();
+    return value;
 }
 
-void BgeConfig::AddProperty(std::string name, BgeConfigProperty& property)
+void BgeConfig::VisitLine(std::string_view line, BgeConfigVisitor& visitor, std::string& fullName, size_t& sectionLength)
 {
-    if (name.empty())
-        return;
+    std::string_view sectionName;
+    line = CleanLine(line);
 
-    if (HasProperty(name))
+    if (line.empty())
         return;
-    
-    size_t sectionDivider = name.find_first_of('.');
-    if (sectionDivider == std::string::npos)
+
+    if (ParseSectionHeader(line, sectionName))
     {
-        property.Name = name;
-        property.SetParent(nullptr);
-        mProperties.push_back(property);
+        fullName.assign(sectionName);
+        sectionLength = fullName.size();
+        visitor.OnSection(sectionName);
         return;
     }
 
-    std::string sectionName = name.substr(0, sectionDivider);
-    std::string nextSectionStr = name.substr(sectionDivider+1);
+    size_t equalSignIdx = line.find_last_of('=');
+    if (equalSignIdx == std::string_view::npos)
+        return;
 
-    BgeConfigSection* nextSection = nullptr;
-    if (!HasSection(sectionName))
-        nextSection = AddSection(sectionName);
-    else
-        nextSection = GetSection(sectionName);
+    BgePropertyValueType type;
+    std::string_view value = ParseValue(TrimView(line.substr(equalSignIdx+1)), type);
 
-    if (nextSection == nullptr)
-        return;
+    // the name buffer only grows, so most properties don't allocate anything
+    fullName.resize(sectionLength);
+    if (sectionLength != 0)
+        fullName.push_back('.');
+    fullName.append(TrimView(line.substr(0, equalSignIdx)));
 
-    nextSection->AddProperty(nextSectionStr, property);
+    visitor.OnProperty(fullName, type, value);
 }
 
-BgeConfigSection* BgeConfig::AddSection(std::string name)
+std::string_view BgeConfig::CleanLine(std::string_view line)
 {
-    if (name.empty())
-        return nullptr;
+    // if the line starts with "//" it is a comment and should be ignored
+    size_t commentIdx = line.find("//");
+    if (commentIdx != std::string_view::npos)
+        line = line.substr(0, commentIdx);
 
-    if (HasSection(name))
-        return GetSection(name);
-
-    size_t sectionDivider = name.find_first_of('.');
-    if (sectionDivider == std::string::npos)
-    {
-        BgeConfigSection section = BgeConfigSection(name);
-        section.SetParent(nullptr);
-        mSections.push_back(section);
-        return &mSections.back();
-    }
+    // remove any whitespaces at the front or end
+    return TrimView(line);
+}
 
-    std::string sectionName = name.substr(0, sectionDivider);
-    std::string nextSectionName = name.substr(sectionDivider+1);
+std::string_view BgeConfig::TrimView(std::string_view str)
+{
+    if (str.find_first_not_of(" \n\t\r\f\v") == std::string_view::npos)
+        return std::string_view();
 
-    return AddSection(sectionName)->AddSubSection(nextSectionName);
+    str.remove_prefix(str.find_first_not_of(" \t\n\r"));
+    str.remove_suffix(str.size() - str.find_last_not_of(" \t\n\r") - 1);
+    return str;
 }
 
-bool BgeConfig::HasProperty(std::string name)
+bool BgeConfig::ParseSectionHeader(std::string_view line, std::string_view& name)
 {
-    if (name.empty())
+    if (line.empty() || line.front() != '[' || line.back() != ']')
         return false;
 
-    size_t sectionDivider = name.find_first_of('.');
-    if (sectionDivider == std::string::npos)
-        return GetPropertyIterator(name) != mProperties.end();
-
-    std::string sectionName = name.substr(0, sectionDivider);
-    std::string nextSectionName = name.substr(sectionDivider+1);
-
-    if (!HasSection(sectionName))
-        return false;
-    
-    return GetSection(sectionName)->HasProperty(nextSectionName);
+    name = line.substr(1, line.size() - 2);
+    return true;
 }
 
-bool BgeConfig::HasSection(std::string name)
+uint64_t BgeConfig::HashBytes(std::string_view data, uint64_t seed)
 {
-    if (name.empty())
-        return false;
+    uint64_t hash = seed;
+    for (char byte : data)
+    {
+        hash ^= (uint8_t)byte;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
 
-    size_t sectionDivider = name.find_first_of('.');
-    if (sectionDivider == std::string::npos)
-        return GetSectionIterator(name) != mSections.end();
-    
-    std::string sectionName = name.substr(0, sectionDivider);
-    std::string nextSectionName = name.substr(sectionDivider+1);
+BgeConfigDifferenceList BgeConfig::Diff(BgeConfig& a, BgeConfig& b)
+{
+    BgeConfigDifferenceList changes;
+    DiffProperties(a.mProperties, b.mProperties, "", changes);
+    DiffSections(a.mSections, b.mSections, "", changes);
+    return changes;
+}
 
-    if (!HasSection(sectionName))
-        return false;
-    
-    return GetSection(sectionName)->HasSubSection(nextSectionName);
+BgeConfigDifferenceList BgeConfig::Diff(BgeConfigSection& a, BgeConfigSection& b)
+{
+    BgeConfigDifferenceList changes;
+    if (a.Hash() == b.Hash())
+        return changes;
+
+    std::string prefix = b.GetFullName();
+    DiffProperties(a.GetProperties(), b.GetProperties(), prefix, changes);
+    DiffSections(a.GetSubSections(), b.GetSubSections(), prefix, changes);
+    return changes;
 }
 
-BgeConfigProperty* BgeConfig::Get(std::string name)
+void BgeConfig::DiffProperties(BgeConfigPropertyList& previous, BgeConfigPropertyList& current, std::string prefix, BgeConfigDifferenceList& changes)
 {
-    if (name.empty())
-        return nullptr;
+    if (!prefix.empty())
+        prefix.append(".");
 
-    size_t sectionDivider = name.find_first_of('.');
-    if (sectionDivider == std::string::npos)
+    std::unordered_map<std::string_view, BgeConfigProperty*> previousByName;
+    for (auto& property : previous)
+        previousByName.emplace(property.Name, &property);
+
+    for (auto& property : current)
     {
-        auto propertyIterator = GetPropertyIterator(name);
-        return (propertyIterator == mProperties.end()) ? nullptr : &*propertyIterator;
-    }
+        auto match = previousByName.find(property.Name);
+        if (match == previousByName.end())
+        {
+            changes.push_back(BgeConfigDifference{prefix + property.Name, nullptr, &property});
+            continue;
+        }
 
-    std::string sectionName = name.substr(0, sectionDivider);
-    std::string nextSectionName = name.substr(sectionDivider+1);
+        if (!property.ValueEquals(*match->second))
+            changes.push_back(BgeConfigDifference{prefix + property.Name, match->second, &property});
 
-    if (!HasSection(sectionName))
-        return nullptr;
+        previousByName.erase(match);
+    }
 
-    return GetSection(sectionName)->Get(nextSectionName);
+    for (auto& removed : previousByName)
+        changes.push_back(BgeConfigDifference{prefix + std::string(removed.first), removed.second, nullptr});
 }
 
-BgeConfigSection* BgeConfig::GetSection(std::string name)
+void BgeConfig::DiffSections(BgeConfigSectionList& previous, BgeConfigSectionList& current, std::string prefix, BgeConfigDifferenceList& changes)
 {
-    if (name.empty())
-        return nullptr;
+    if (!prefix.empty())
+        prefix.append(".");
 
-    size_t sectionDivider = name.find_first_of('.');
-    if (sectionDivider == std::string::npos)
-    {
-        auto sectionIterator = GetSectionIterator(name);
-        return (sectionIterator == mSections.end()) ? nullptr : &*sectionIterator;
-    }
+    std::unordered_map<std::string_view, BgeConfigSection*> previousByName;
+    for (auto& section : previous)
+        previousByName.emplace(section.Name, &section);
 
-    std::string sectionName = name.substr(0, sectionDivider);
-    std::string nextSectionName = name.substr(sectionDivider+1);
+    BgeConfigPropertyList noProperties;
+    BgeConfigSectionList noSections;
 
-    if (!HasSection(sectionName))
-        return nullptr;
+    for (auto& section : current)
+    {
+        auto match = previousByName.find(section.Name);
+        BgeConfigSection* previousSection = (match == previousByName.end()) ? nullptr : match->second;
+        if (match != previousByName.end())
+            previousByName.erase(match);
 
-    return GetSection(sectionName)->GetSubSection(nextSectionName);
-}
+        // identical sub-trees don't have to be looked at
+        if (previousSection != nullptr && previousSection->Hash() == section.Hash())
+            continue;
 
-BgeConfigPropertyList& BgeConfig::GetProperties()
-{
-    return mProperties;
-}
+        DiffProperties(previousSection ? previousSection->GetProperties() : noProperties, section.GetProperties(), prefix + section.Name, changes);
+        DiffSections(previousSection ? previousSection->GetSubSections() : noSections, section.GetSubSections(), prefix + section.Name, changes);
+    }
 
-BgeConfigSectionList& BgeConfig::GetSections()
-{
-    return mSections;
+    for (auto& removed : previousByName)
+    {
+        DiffProperties(removed.second->GetProperties(), noProperties, prefix + removed.second->Name, changes);
+        DiffSections(removed.second->GetSubSections(), noSections, prefix + removed.second->Name, changes);
+    }
 }
 
-BgePropertyValueType BgeConfig::EstimateValueType(std::string value)
+void BgeConfig::NotifyChanges(BgeConfigDifferenceList& changes)
 {
-    if (value.empty())
-        return BgePropertyValueType::UNKNOWN;
+    // callbacks may subscribe or unsubscribe, so we gather the ones to call first
+    std::vector<std::pair<BgeConfigChangeCallback, BgeConfigDifference*>> calls;
 
-    if (StringIsBool(value))
-        return BgePropertyValueType::BOOL;
+    for (auto& change : changes)
+    {
+        auto exact = mExactSubscribers.find(change.FullName);
+        if (exact != mExactSubscribers.end())
+            for (auto& subscription : exact->second)
+                calls.emplace_back(subscription.Callback, &change);
 
-    if (StringIsNumber(value))
-        return BgePropertyValueType::INT;
+        if (mPrefixSubscribers.empty())
+            continue;
 
-    if (StringIsFloat(value))
-        return BgePropertyValueType::FLOAT;
+        // walk up the section path, "A.B.C" checks "A.B", "A" and finally "" (which is "*")
+        std::string_view sectionName = change.FullName;
+        while (true)
+        {
+            size_t sectionDivider = sectionName.find_last_of('.');
+            sectionName = (sectionDivider == std::string_view::npos) ? std::string_view() : sectionName.substr(0, sectionDivider);
 
-    return BgePropertyValueType::STRING;
-}
+            auto prefix = mPrefixSubscribers.find(std::string(sectionName));
+            if (prefix != mPrefixSubscribers.end())
+                for (auto& subscription : prefix->second)
+                    calls.emplace_back(subscription.Callback, &change);
 
-BgeConfigPropertyList::iterator BgeConfig::GetPropertyIterator(std::string name)
-{
-    return std::find_if(mProperties.begin(), mProperties.end(), [name](BgeConfigProperty& other){ return name == other.Name; });
-}
+            if (sectionName.empty())
+                break;
+        }
+    }
 
-BgeConfigSectionList::iterator BgeConfig::GetSectionIterator(std::string name)
-{
-    return std::find_if(mSections.begin(), mSections.end(), [name](BgeConfigSection& other){ return name == other.Name; });
+    for (auto& call : calls)
+        call.first(call.second->FullName, call.second->Current);
 }
 
-bool BgeConfig::StringIsNumber(std::string str)
+bool BgeConfig::StringIsNumber(std::string_view str)
 {
     int index = 0;
     char chr = str.at(index);
@@ -999,7 +3500,7 @@ bool BgeConfig::StringIsNumber(std::string str)
     return true;
 }
 
-bool BgeConfig::StringIsFloat(std::string str)
+bool BgeConfig::StringIsFloat(std::string_view str)
 {
     int index = 0;
     char chr = str.at(index);
@@ -1028,7 +3529,7 @@ bool BgeConfig::StringIsFloat(std::string str)
     return true;
 }
 
-bool BgeConfig::StringIsBool(std::string str)
+bool BgeConfig::StringIsBool(std::string_view str)
 {
     // yes this is a cheap and stupid solution but it works
     return str == "True"  ||
@@ -1037,6 +3538,18 @@ bool BgeConfig::StringIsBool(std::string str)
         str == "false";
 }
 
+float BgeConfig::StringToFloat(std::string_view str)
+{
+    if (!str.empty() && str.front() == '+')
+        str.remove_prefix(1);
+
+    float value = 0.f;
+    if (std::from_chars(str.data(), str.data() + str.size(), value).ec != std::errc())
+        return 0.f;
+
+    return value;
+}
+
 std::string BgeConfig::StringTrimLeading(std::string str)
 {
     if (str.find_first_not_of(" \n\t\r\f\v") == std::string::npos)
@@ -0,0 +1,206 @@
+/**
+ * @file BgeConfigLayers.hpp
+ * @author GAMINGNOOBdev (https://github.com/GAMINGNOOBdev)
+ * @brief Stacked configuration layers with a flattened lookup in a single header for C++
+ * @note This header does depend on BgeConfig.hpp
+ * @version 1.0
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) GAMINGNOOBdev 2024
+ */
+
+#ifndef __BGECONFIGLAYERS_HPP_
+#define __BGECONFIGLAYERS_HPP_ 1
+
+#include <BgeConfig.hpp>
+#include <unordered_map>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+/**
+ * A stack of configurations where upper layers override the properties of lower ones,
+ * e.g. defaults, then per-platform, then per-user, then command line overrides
+ *
+ * @note All layers are resolved into one flattened index up front, so `Get` is a single
+ *       lookup no matter how many layers there are. The index only points into the layers,
+ *       nothing gets copied. It is rebuilt on the next lookup once the generation of a layer
+ *       changed (see `BgeConfig::GetGeneration`), call `Rebuild` after adding properties to
+ *       a section of a layer by hand. The layers have to outlive this stack.
+*/
+struct BgeConfigLayers
+{
+    /**
+     * Creates a new empty `BgeConfigLayers` stack
+    */
+    BgeConfigLayers()
+        : mLayers(), mIndex(), mDirty(false)
+    {
+    }
+
+    /**
+     * Puts a configuration on top of the stack
+     * @param config The configuration, its properties override the ones of all layers below
+    */
+    void Push(BgeConfig& config)
+    {
+        mLayers.push_back(Layer{&config, 0});
+        mDirty = true;
+    }
+
+    /**
+     * Removes the topmost configuration from the stack
+    */
+    void Pop()
+    {
+        if (mLayers.empty())
+            return;
+
+        mLayers.pop_back();
+        mDirty = true;
+    }
+
+    /**
+     * Removes all configurations from the stack
+    */
+    void Clear()
+    {
+        mLayers.clear();
+        mIndex.clear();
+        mDirty = false;
+    }
+
+    /**
+     * Resolves all layers into the flattened index again
+    */
+    void Rebuild()
+    {
+        mIndex.clear();
+        mDirty = false;
+
+        std::string prefix;
+        for (auto& layer : mLayers)
+        {
+            layer.Generation = layer.Config->GetGeneration();
+            IndexProperties(layer.Config->GetProperties(), prefix);
+            IndexSections(layer.Config->GetSections(), prefix);
+        }
+    }
+
+    /**
+     * Gets the property of the topmost layer that has it
+     * @param name full name of the desired property
+     * @returns desired property, NULL if no layer has it
+    */
+    BgeConfigProperty* Get(std::string name)
+    {
+        if (Outdated())
+            Rebuild();
+
+        auto entry = mIndex.find(name);
+        if (entry == mIndex.end())
+            return nullptr;
+
+        return entry->second;
+    }
+
+    /**
+     * Checks if any layer has a specific property
+     * @param name full name of the desired property
+     * @returns `true` if the property exists, otherwise `false`
+    */
+    bool HasProperty(std::string name)
+    {
+        return Get(name) != nullptr;
+    }
+
+    /**
+     * @returns The configuration of a layer, `0` is the bottom one
+    */
+    BgeConfig* GetLayer(size_t index)
+    {
+        if (index >= mLayers.size())
+            return nullptr;
+
+        return mLayers[index].Config;
+    }
+
+    /**
+     * @returns The number of layers
+    */
+    size_t LayerCount()
+    {
+        return mLayers.size();
+    }
+
+    /**
+     * @returns The number of distinct properties over all layers
+    */
+    size_t Size()
+    {
+        if (Outdated())
+            Rebuild();
+
+        return mIndex.size();
+    }
+
+private:
+    /**
+     * A configuration on the stack
+    */
+    struct Layer
+    {
+        // The configuration of this layer
+        BgeConfig* Config;
+
+        // Generation of the configuration when the index was built
+        uint64_t Generation;
+    };
+
+    /**
+     * @returns `true` if the index has to be rebuilt, otherwise `false`
+    */
+    bool Outdated()
+    {
+        if (mDirty)
+            return true;
+
+        for (auto& layer : mLayers)
+            if (layer.Config->GetGeneration() != layer.Generation)
+                return true;
+
+        return false;
+    }
+
+    void IndexProperties(BgeConfigPropertyList& properties, std::string& prefix)
+    {
+        size_t prefixLength = prefix.size();
+
+        for (auto& property : properties)
+        {
+            prefix.append(property.Name);
+            mIndex[prefix] = &property;
+            prefix.resize(prefixLength);
+        }
+    }
+
+    void IndexSections(BgeConfigSectionList& sections, std::string& prefix)
+    {
+        size_t prefixLength = prefix.size();
+
+        for (auto& section : sections)
+        {
+            prefix.append(section.Name).append(".");
+            IndexProperties(section.GetProperties(), prefix);
+            IndexSections(section.GetSubSections(), prefix);
+            prefix.resize(prefixLength);
+        }
+    }
+
+private:
+    std::vector<Layer> mLayers;
+    std::unordered_map<std::string, BgeConfigProperty*> mIndex;
+    bool mDirty;
+};
+
+#endif
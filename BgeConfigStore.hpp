@@ -0,0 +1,322 @@
+/**
+ * @file BgeConfigStore.hpp
+ * @author GAMINGNOOBdev (https://github.com/GAMINGNOOBdev)
+ * @brief A lock-free holder for hot-reloadable configuration snapshots in a single header for C++
+ * @note This header does depend on BgeConfig.hpp
+ * @version 1.0
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) GAMINGNOOBdev 2024
+ */
+
+#ifndef __BGECONFIGSTORE_HPP_
+#define __BGECONFIGSTORE_HPP_ 1
+
+#include <BgeConfig.hpp>
+#include <algorithm>
+#include <functional>
+#include <stdint.h>
+#include <atomic>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <unordered_map>
+
+#ifndef BGE_CONFIG_STORE_SLOTS
+#   define BGE_CONFIG_STORE_SLOTS 128
+#endif
+
+/**
+ * A single reader slot of a `BgeConfigStore`, padded to its own cache line
+ * so that readers on different cores don't fight over the same line
+*/
+struct alignas(64) BgeConfigStoreSlot
+{
+    // The snapshot which is currently being read through this slot, `nullptr` if the slot is free
+    std::atomic<BgeConfig*> Pointer;
+};
+
+struct BgeConfigStore;
+
+/**
+ * A read handle to one published configuration snapshot
+ *
+ * @note The snapshot stays alive for as long as this handle exists, even if a newer one
+ *       gets published in the meantime. The configuration is read-only.
+*/
+struct BgeConfigSnapshot
+{
+    BgeConfigSnapshot()
+        : mSlot(nullptr), mStore(nullptr), mConfig(nullptr)
+    {
+    }
+
+    /**
+     * Creates a snapshot that is read through a hazard slot
+    */
+    BgeConfigSnapshot(BgeConfigStoreSlot* slot, const BgeConfig* config)
+        : mSlot(slot), mStore(nullptr), mConfig(config)
+    {
+    }
+
+    /**
+     * Creates a snapshot that is counted by the store, because every slot was taken
+    */
+    BgeConfigSnapshot(BgeConfigStore* store, const BgeConfig* config)
+        : mSlot(nullptr), mStore(store), mConfig(config)
+    {
+    }
+
+    BgeConfigSnapshot(BgeConfigSnapshot&& other) noexcept
+        : mSlot(other.mSlot), mStore(other.mStore), mConfig(other.mConfig)
+    {
+        other.mSlot = nullptr;
+        other.mStore = nullptr;
+        other.mConfig = nullptr;
+    }
+
+    BgeConfigSnapshot& operator=(BgeConfigSnapshot&& other) noexcept
+    {
+        if (this == &other)
+            return *this;
+
+        Release();
+        mSlot = other.mSlot;
+        mStore = other.mStore;
+        mConfig = other.mConfig;
+        other.mSlot = nullptr;
+        other.mStore = nullptr;
+        other.mConfig = nullptr;
+        return *this;
+    }
+
+    BgeConfigSnapshot(const BgeConfigSnapshot&) = delete;
+    BgeConfigSnapshot& operator=(const BgeConfigSnapshot&) = delete;
+
+    /**
+     * Releases this snapshot
+    */
+    ~BgeConfigSnapshot()
+    {
+        Release();
+    }
+
+    /**
+     * Gives up the read access to this snapshot early
+     * @note the snapshot may be reclaimed by the next publication after this call
+    */
+    void Release();
+
+    /**
+     * @returns The configuration of this snapshot, `nullptr` if released
+    */
+    const BgeConfig* Get()
+    {
+        return mConfig;
+    }
+
+    const BgeConfig* operator->()
+    {
+        return mConfig;
+    }
+
+    const BgeConfig& operator*()
+    {
+        return *mConfig;
+    }
+
+private:
+    BgeConfigStoreSlot* mSlot;
+
+    // Store that counts this snapshot, only set if it isn't read through a slot
+    BgeConfigStore* mStore;
+
+    const BgeConfig* mConfig;
+};
+
+/**
+ * Holds the current configuration behind an atomic pointer
+ *
+ * Readers on any thread acquire a consistent snapshot without taking a lock (each reader
+ * publishes the snapshot it is reading in a hazard slot). Reloads parse into a brand new
+ * `BgeConfig` and swap it in atomically, old snapshots are only deleted once no reader
+ * holds them anymore.
+*/
+struct BgeConfigStore
+{
+    /**
+     * Creates a new `BgeConfigStore` holding an empty configuration
+    */
+    BgeConfigStore()
+        : mCurrent(new BgeConfig()), mRetired(), mOverflow()
+    {
+        for (auto& slot : mSlots)
+            slot.Pointer.store(nullptr, std::memory_order_relaxed);
+    }
+
+    BgeConfigStore(const BgeConfigStore&) = delete;
+    BgeConfigStore& operator=(const BgeConfigStore&) = delete;
+
+    /**
+     * Destroys this `BgeConfigStore` and every snapshot it still owns
+     * @note No snapshot of this store may be alive at this point
+    */
+    ~BgeConfigStore()
+    {
+        delete mCurrent.load(std::memory_order_acquire);
+        for (auto config : mRetired)
+            delete config;
+    }
+
+    /**
+     * Acquires the currently published configuration
+     * @note Once all `BGE_CONFIG_STORE_SLOTS` slots are held, snapshots are counted under a
+     *       lock instead, which is slower but never runs out
+     * @returns A handle that keeps the snapshot alive until it is destroyed
+    */
+    BgeConfigSnapshot Acquire()
+    {
+        size_t start = std::hash<std::thread::id>()(std::this_thread::get_id());
+
+        for (size_t attempt = 0; attempt < BGE_CONFIG_STORE_SLOTS; attempt++)
+        {
+            BgeConfigStoreSlot& slot = mSlots[(start + attempt) % BGE_CONFIG_STORE_SLOTS];
+            BgeConfig* current = mCurrent.load(std::memory_order_acquire);
+            BgeConfig* expected = nullptr;
+
+            if (!slot.Pointer.compare_exchange_strong(expected, current))
+                continue;
+
+            // the pointer could have been swapped and retired before our slot became visible
+            // to the writer, so we only trust it once it is still the current one afterwards
+            BgeConfig* validated = mCurrent.load();
+            while (validated != current)
+            {
+                current = validated;
+                slot.Pointer.store(current);
+                validated = mCurrent.load();
+            }
+
+            return BgeConfigSnapshot(&slot, current);
+        }
+
+        // the writer lock keeps the current configuration from being retired in the meantime
+        std::lock_guard<std::mutex> lock(mWriterLock);
+        BgeConfig* current = mCurrent.load();
+        mOverflow[current]++;
+        return BgeConfigSnapshot(this, current);
+    }
+
+    /**
+     * Publishes a new configuration, readers acquiring after this call will see it
+     * @param config The new configuration, this store takes ownership of it
+    */
+    void Publish(std::unique_ptr<BgeConfig> config)
+    {
+        if (config == nullptr)
+            return;
+
+        std::lock_guard<std::mutex> lock(mWriterLock);
+        mRetired.push_back(mCurrent.exchange(config.release()));
+        ReclaimRetired();
+    }
+
+    /**
+     * Parses a configuration file into a new tree and publishes it
+     * @note The previous configuration stays published if the file could not be opened
+     * @param path file path to the configuration file to load
+     * @returns `true` if the new configuration was published, otherwise `false`
+    */
+    bool Reload(std::string path)
+    {
+        std::unique_ptr<BgeConfig> config = std::unique_ptr<BgeConfig>(new BgeConfig());
+        if (!config->Open(path))
+            return false;
+
+        Publish(std::move(config));
+        return true;
+    }
+
+    /**
+     * Does the same as `Reload` but parses on a separate thread
+     * @param path file path to the configuration file to load
+     * @returns A future holding the result of `Reload`
+    */
+    std::future<bool> ReloadAsync(std::string path)
+    {
+        return std::async(std::launch::async, [this, path](){ return Reload(path); });
+    }
+
+    /**
+     * Deletes every retired snapshot which is no longer being read
+     * @note This is called automatically by `Publish`
+    */
+    void Reclaim()
+    {
+        std::lock_guard<std::mutex> lock(mWriterLock);
+        ReclaimRetired();
+    }
+
+private:
+    friend struct BgeConfigSnapshot;
+
+    /**
+     * Gives up a snapshot that was counted because every slot was taken
+    */
+    void ReleaseOverflow(const BgeConfig* config)
+    {
+        std::lock_guard<std::mutex> lock(mWriterLock);
+        auto entry = mOverflow.find(config);
+        if (entry != mOverflow.end() && --entry->second == 0)
+            mOverflow.erase(entry);
+    }
+
+    void ReclaimRetired()
+    {
+        auto stillRead = [this](BgeConfig* config){
+            if (mOverflow.count(config) != 0)
+                return true;
+
+            for (auto& slot : mSlots)
+                if (slot.Pointer.load() == config)
+                    return true;
+            return false;
+        };
+
+        auto retiredEnd = std::remove_if(mRetired.begin(), mRetired.end(), [&stillRead](BgeConfig* config){
+            if (stillRead(config))
+                return false;
+
+            delete config;
+            return true;
+        });
+        mRetired.erase(retiredEnd, mRetired.end());
+    }
+
+private:
+    BgeConfigStoreSlot mSlots[BGE_CONFIG_STORE_SLOTS];
+    std::atomic<BgeConfig*> mCurrent;
+    std::vector<BgeConfig*> mRetired;
+
+    // Number of snapshots of each configuration that are counted because every slot was taken
+    std::unordered_map<const BgeConfig*, size_t> mOverflow;
+
+    std::mutex mWriterLock;
+};
+
+inline void BgeConfigSnapshot::Release()
+{
+    if (mSlot != nullptr)
+        mSlot->Pointer.store(nullptr, std::memory_order_release);
+
+    if (mStore != nullptr)
+        mStore->ReleaseOverflow(mConfig);
+
+    mSlot = nullptr;
+    mStore = nullptr;
+    mConfig = nullptr;
+}
+
+#endif
@@ -15,10 +15,15 @@
 #   pragma warning(disable: 4996)
 #endif
 
+#include <BgeIoBackend.hpp>
+#include <type_traits>
+#include <chrono>
 #include <stdint.h>
 #include <memory.h>
 #include <stdio.h>
+#include <memory>
 #include <string>
+#include <vector>
 
 #ifndef BGEFILE_SILENCED
 #   define BGE_LOG printf
@@ -28,30 +33,164 @@
 
 #ifdef _WIN32
 #   include <sstream>
+#   include <io.h>
+#   ifndef NOMINMAX
+#       define NOMINMAX
+#   endif
+#   ifndef WIN32_LEAN_AND_MEAN
+#       define WIN32_LEAN_AND_MEAN
+#   endif
+#   include <windows.h>
 #else
 #   include <iomanip>
+#   include <sys/stat.h>
+#   include <unistd.h>
+#   include <fcntl.h>
+#endif
+
+// Readers that read this many bytes front to back get a sequential access hint, `0` turns it off
+#ifndef BGE_FILE_SEQUENTIAL_HINT
+#   define BGE_FILE_SEQUENTIAL_HINT (4 * 1024 * 1024)
 #endif
 
+/**
+ * Options for opening a `BgeFile`
+*/
+enum class BgeFileFlags : uint32_t
+{
+    NONE = 0,
+
+    // Writers write into a temporary file next to the target, which replaces the target on `Close`
+    ATOMIC = 1 << 0,
+
+    // Writers keep the contents of an existing file and write at its end
+    APPEND = 1 << 1,
+
+    // Bypasses the page cache with a `BgeDirectBackend` if no backend is given, for huge files that are streamed once
+    UNBUFFERED = 1 << 2,
+
+    // Reads ahead on a background thread with a `BgeReadAheadBackend` around the backend, for files that are streamed front to back
+    READ_AHEAD = 1 << 3,
+
+    // Writes on a background thread with a `BgeWriteBehindBackend` around the backend, so writing never waits for the disk
+    WRITE_BEHIND = 1 << 4,
+};
+
+inline BgeFileFlags operator|(BgeFileFlags a, BgeFileFlags b)
+{
+    return (BgeFileFlags)((uint32_t)a | (uint32_t)b);
+}
+
+inline BgeFileFlags operator&(BgeFileFlags a, BgeFileFlags b)
+{
+    return (BgeFileFlags)((uint32_t)a & (uint32_t)b);
+}
+
+/**
+ * When a writer makes sure its data reached the disk
+*/
+enum class BgeDurability : uint8_t
+{
+    // Only when asked to with `Sync`, atomic writers still sync before replacing the target
+    NONE,
+
+    // On `Close`
+    ON_CLOSE,
+
+    // On `Close` and whenever `BgeDurabilityPolicy::Bytes` or `BgeDurabilityPolicy::Milliseconds` were reached
+    PERIODIC,
+
+    // Like `PERIODIC`, but writers syncing at the same time share their syncs, see `BgeGroupCommit`
+    GROUP_COMMIT,
+};
+
+/**
+ * Durability settings of a `BgeFile` writer
+*/
+struct BgeDurabilityPolicy
+{
+    BgeDurability Level = BgeDurability::NONE;
+
+    // Syncs once this many bytes were written since the last sync, `0` for no limit
+    uint64_t Bytes = 0;
+
+    // Syncs on the next write once this much time passed since the last sync, `0` for no limit
+    uint32_t Milliseconds = 0;
+
+    // Group that shares the syncs of `GROUP_COMMIT`, `BgeGroupCommit::Shared()` if not set
+    BgeGroupCommit* Group = nullptr;
+};
+
 /**
  * Like a normal `FILE*` but more advanced
+ *
+ * @note Use `BgeFile` to pick a backend per file (stdio if none is given). Using a backend
+ *       type directly, e.g. `BgeBasicFile<BgePosixBackend>`, fixes the backend at compile time
+ *       and gets rid of the virtual calls.
+ *
+ * @tparam Backend The `BgeIoBackend` that does the actual work
 */
-struct BgeFile
+template <typename Backend = BgeIoBackend>
+struct BgeBasicFile
 {
     /**
      * Creates a new `BgeFile`
      * @param path File path
      * @param write If the file should be read-write or read-only
+     * @param flags Additional options, see `BgeFileFlags`
+     * @param backend Backend that does the actual work, a default one is created if not set
     */
-    BgeFile(std::string path, bool write = false)
-        : mWriter(write), mReady(false), mCursor(0), mPath(path), mEOF(false), mSize(0)
+    BgeBasicFile(std::string path, bool write = false, BgeFileFlags flags = BgeFileFlags::NONE, std::unique_ptr<Backend> backend = nullptr)
+        : mBackend(CreateBackend(flags, std::move(backend))), mPath(path), mCursor(0), mSize(0), mWriter(write), mReady(false), mEOF(false), mFlags(flags), mTempPath(),
+          mSequentialEnd(0), mSequentialLength(0), mSequentialAdvised(false), mDurability(), mUnsynced(0), mLastSync()
     {
         Open();
     }
 
+    BgeBasicFile(BgeBasicFile&& other) noexcept
+        : mBackend(std::move(other.mBackend)), mPath(std::move(other.mPath)), mCursor(other.mCursor), mSize(other.mSize),
+          mWriter(other.mWriter), mReady(other.mReady), mEOF(other.mEOF), mFlags(other.mFlags), mTempPath(std::move(other.mTempPath)),
+          mSequentialEnd(other.mSequentialEnd), mSequentialLength(other.mSequentialLength), mSequentialAdvised(other.mSequentialAdvised),
+          mDurability(other.mDurability), mUnsynced(other.mUnsynced), mLastSync(other.mLastSync)
+    {
+        other.mReady = false;
+        other.mTempPath.clear();
+    }
+
+    BgeBasicFile& operator=(BgeBasicFile&& other) noexcept
+    {
+        if (this == &other)
+            return *this;
+
+        Close();
+        mBackend = std::move(other.mBackend);
+        mPath = std::move(other.mPath);
+        mCursor = other.mCursor;
+        mSize = other.mSize;
+        mWriter = other.mWriter;
+        mReady = other.mReady;
+        mEOF = other.mEOF;
+        mFlags = other.mFlags;
+        mTempPath = std::move(other.mTempPath);
+        mSequentialEnd = other.mSequentialEnd;
+        mSequentialLength = other.mSequentialLength;
+        mSequentialAdvised = other.mSequentialAdvised;
+        mDurability = other.mDurability;
+        mUnsynced = other.mUnsynced;
+        mLastSync = other.mLastSync;
+
+        other.mReady = false;
+        other.mTempPath.clear();
+        return *this;
+    }
+
+    BgeBasicFile(const BgeBasicFile&) = delete;
+    BgeBasicFile& operator=(const BgeBasicFile&) = delete;
+
     /**
      * Destroy this `BgeFile`
     */
-    ~BgeFile()
+    ~BgeBasicFile()
     {
         Close();
     }
@@ -68,19 +207,34 @@ struct BgeFile
 
         Close();
 
-        mFileHandle = fopen(mPath.c_str(), mWriter ? "wb+" : "rb");
+        // a file that was moved away from lost its backend
+        if (mBackend == nullptr)
+            mBackend = CreateBackend(mFlags, nullptr);
+
+        bool opened = false;
+        if (mWriter && HasFlag(BgeFileFlags::ATOMIC))
+            opened = OpenTemporary();
+        else if (mWriter && HasFlag(BgeFileFlags::APPEND))
+            opened = mBackend->Open(mPath, BgeIoMode::APPEND);
+        else
+            opened = mBackend->Open(mPath, mWriter ? BgeIoMode::WRITE : BgeIoMode::READ);
 
-        if (mFileHandle == nullptr)
+        if (!opened)
         {
             BGE_LOG("Could not open file \"%s\": File not found/couldn't be created\n", mPath.c_str());
             return;
         }
         mCursor = 0;
         mEOF = false;
+        mSize = mBackend->Size();
+        mSequentialEnd = mSequentialLength = 0;
+        mSequentialAdvised = false;
+        mUnsynced = 0;
+        mLastSync = std::chrono::steady_clock::now();
 
-        fseek(mFileHandle, 0, SEEK_END);
-        mSize = ftell(mFileHandle);
-        fseek(mFileHandle, 0, SEEK_SET);
+        // writers report their cursor as size, so appending continues after the existing data
+        if (mWriter && HasFlag(BgeFileFlags::APPEND))
+            mCursor = mSize;
 
         mReady = true;
     }
@@ -100,14 +254,107 @@ struct BgeFile
 
     /**
      * Closes this `BgeFile`
+     * @note Atomic writers flush their data to the disk and replace the target file here, other
+     *       writers only sync if their `BgeDurability` asks for it
+     * @returns `false` if an atomic writer could not replace the target file or the data could not
+     *          be synced, otherwise `true`
     */
-    void Close()
+    bool Close()
     {
         if (!mReady)
+            return true;
+
+        // atomic writers always sync before the rename, there is no need to do it twice
+        bool synced = !mWriter || mDurability.Level == BgeDurability::NONE || !mTempPath.empty() || Sync();
+        mReady = false;
+
+        if (!mTempPath.empty())
+            return CommitTemporary() && synced;
+
+        return mBackend->Close() && synced;
+    }
+
+    /**
+     * Hands everything written so far over to the operating system
+     * @note This does not wait for the data to reach the disk
+    */
+    void Flush()
+    {
+        if (!mReady || !mWriter)
             return;
 
-        fclose(mFileHandle);
+        mBackend->Flush();
+    }
+
+    /**
+     * Waits until everything written so far reached the disk
+     * @note With `BgeDurability::GROUP_COMMIT` the sync is shared with other writers syncing at the same time
+     * @returns `true` if the data is on the disk, otherwise `false`
+    */
+    bool Sync()
+    {
+        if (!mReady || !mWriter)
+            return false;
+
+        mUnsynced = 0;
+        mLastSync = std::chrono::steady_clock::now();
+
+        if (mDurability.Level != BgeDurability::GROUP_COMMIT)
+            return mBackend->Sync();
+
+        BgeGroupCommit& group = (mDurability.Group != nullptr) ? *mDurability.Group : BgeGroupCommit::Shared();
+        return group.Commit(*mBackend);
+    }
+
+    /**
+     * Allocates the disk space for the file to grow to `size` bytes up front, so a big file that
+     * is written in many small steps ends up in few large pieces on the disk
+     * @param size Size of the file in bytes the space is allocated for
+     * @param trim If space that wasn't written to is given back on `Close`
+     * @returns `true` if the space was allocated, otherwise `false`
+    */
+    bool Reserve(uint64_t size, bool trim = true)
+    {
+        if (!mReady || !mWriter)
+            return false;
+
+        return mBackend->Reserve(size, trim);
+    }
+
+    /**
+     * Sets when this writer makes sure its data reached the disk
+     * @param durability The durability settings, see `BgeDurabilityPolicy`
+    */
+    void SetDurability(BgeDurabilityPolicy durability)
+    {
+        mDurability = durability;
+    }
+
+    /**
+     * @returns The durability settings of this writer
+    */
+    BgeDurabilityPolicy GetDurability()
+    {
+        return mDurability;
+    }
+
+    /**
+     * Closes this `BgeFile` without replacing the target file
+     * @note Only atomic writers can discard what they wrote, everything else just closes
+    */
+    void Discard()
+    {
+        if (!mReady)
+            return;
+
+        mBackend->Close();
         mReady = false;
+
+        if (mTempPath.empty())
+            return;
+
+        remove(mTempPath.c_str());
+        mTempPath.clear();
     }
 
     /**
@@ -121,7 +368,7 @@ struct BgeFile
     /**
      * @returns The size of the file
     */
-    size_t Size()
+    uint64_t Size()
     {
         if (mWriter)
             return mCursor;
@@ -138,6 +385,14 @@ struct BgeFile
         return mReady;
     }
 
+    /**
+     * @returns `true` if this `BgeFile` was opened for writing, otherwise `false`
+    */
+    bool IsWriter()
+    {
+        return mWriter;
+    }
+
     /**
      * @returns The file path
     */
@@ -165,12 +420,14 @@ struct BgeFile
             return;
         }
 
-        // fetches the number of successfully read elements
-        size_t status = fread(__dst, __elmnt_sz, __n, mFileHandle);
+        TrackSequential(offset);
+
+        // fetches the number of successfully read bytes
+        size_t status = mBackend->Read(__dst, offset, mCursor);
 
-        mEOF = status != __n;
+        mEOF = status != offset;
 
-        mCursor += __n * __elmnt_sz;
+        mCursor += offset;
     }
 
     /**
@@ -253,9 +510,8 @@ struct BgeFile
         if (!mReady || !mWriter)
             return;
 
-        fwrite(__src, __elmnt_sz, __n, mFileHandle);
-
-        mCursor += __n * __elmnt_sz;
+        // a full disk or memory region only moves the cursor as far as it could write
+        Advance(mBackend->Write(__src, __n * __elmnt_sz, mCursor));
     }
 
     /**
@@ -308,13 +564,11 @@ struct BgeFile
      * Seeks to the position of the file relative to the cursor
      * @param offset Where to seek to
     */
-    void Seek(int offset)
+    void Seek(int64_t offset)
     {
         if (!mReady || mWriter)
             return;
 
-        fseek(mFileHandle, offset, SEEK_CUR);
-
         mCursor += offset;
     }
 
@@ -327,8 +581,6 @@ struct BgeFile
         if (!mReady || mWriter)
             return;
 
-        fseek(mFileHandle, cursor, SEEK_SET);
-
         mCursor = cursor;
     }
 
@@ -348,8 +600,7 @@ struct BgeFile
         if (!mReady || mWriter)
             return;
 
-        fseek(mFileHandle, 0, SEEK_END);
-        mCursor = ftell(mFileHandle);
+        mCursor = mSize;
     }
 
     /**
@@ -358,10 +609,60 @@ struct BgeFile
     */
     uint64_t GetCursor()
     {
-        mCursor = ftell(mFileHandle);
         return mCursor;
     }
 
+    /**
+     * Tells the operating system how a range of the file is going to be accessed
+     * @note Readers that read big parts of the file front to back get `BgeIoAdvice::SEQUENTIAL`
+     *       automatically, see `BGE_FILE_SEQUENTIAL_HINT`
+     * @param advice How the range is accessed
+     * @param offset Start of the range
+     * @param length Length of the range, `0` reaches to the end of the file
+     * @returns `true` if the hint was applied, otherwise `false`
+    */
+    bool Advise(BgeIoAdvice advice, uint64_t offset = 0, uint64_t length = 0)
+    {
+        if (!mReady)
+            return false;
+
+        // an explicit hint replaces the automatic one
+        mSequentialAdvised = true;
+        return mBackend->Advise(advice, offset, length);
+    }
+
+    /**
+     * Copies a range of this file to the cursor of a writer
+     * @note Copies inside the kernel without passing the data through this process where possible,
+     *       which can even share the blocks on file systems with reflinks (see `BgeCopyRange`)
+     * @param dst The writer, its cursor moves past the copied data
+     * @param offset Start of the range in this file
+     * @param length Length of the range, reaches to the end of this file if too long
+     * @returns Number of bytes that were copied
+    */
+    template <typename Other>
+    uint64_t CopyTo(BgeBasicFile<Other>& dst, uint64_t offset = 0, uint64_t length = UINT64_MAX)
+    {
+        if (!mReady || !dst.mReady || !dst.mWriter || offset > Size())
+            return 0;
+
+        length = std::min(length, Size() - offset);
+        uint64_t copied = BgeCopyRange(*mBackend, offset, *dst.mBackend, dst.mCursor, length);
+        dst.Advance(copied);
+        return copied;
+    }
+
+    /**
+     * @returns The backend of this file
+    */
+    Backend& GetBackend()
+    {
+        if (mBackend == nullptr)
+            mBackend = CreateBackend(mFlags, nullptr);
+
+        return *mBackend;
+    }
+
     /**
      * @returns The string representation of this `BgeFile`
     */
@@ -380,9 +681,194 @@ struct BgeFile
 
 private:
     /**
-     * @brief Internal file handle
+     * @returns `backend` (or a default one if not set), wrapped by the backends `flags` ask for
+    */
+    static std::unique_ptr<Backend> CreateBackend(BgeFileFlags flags, std::unique_ptr<Backend> backend)
+    {
+        if (backend == nullptr)
+            backend = CreateDefaultBackend(flags);
+
+        if constexpr (std::is_abstract<Backend>::value)
+            if ((flags & BgeFileFlags::READ_AHEAD) == BgeFileFlags::READ_AHEAD)
+                backend = std::unique_ptr<Backend>(new BgeReadAheadBackend(std::move(backend)));
+
+        if constexpr (std::is_abstract<Backend>::value)
+            if ((flags & BgeFileFlags::WRITE_BEHIND) == BgeFileFlags::WRITE_BEHIND)
+                backend = std::unique_ptr<Backend>(new BgeWriteBehindBackend(std::move(backend)));
+
+        return backend;
+    }
+
+    /**
+     * @returns A stdio backend (or an unbuffered one if requested) if `Backend` is only the interface, otherwise a new `Backend`
+    */
+    static std::unique_ptr<Backend> CreateDefaultBackend(BgeFileFlags flags)
+    {
+        if constexpr (std::is_abstract<Backend>::value)
+        {
+#ifndef _WIN32
+            if ((flags & BgeFileFlags::UNBUFFERED) == BgeFileFlags::UNBUFFERED)
+                return std::unique_ptr<Backend>(new BgeDirectBackend());
+#endif
+            return std::unique_ptr<Backend>(new BgeStdioBackend());
+        }
+        else
+            return std::unique_ptr<Backend>(new Backend());
+    }
+
+    /**
+     * @returns `true` if the given flag was passed when creating this file
+    */
+    bool HasFlag(BgeFileFlags flag)
+    {
+        return (mFlags & flag) == flag;
+    }
+
+    template <typename Other>
+    friend struct BgeBasicFile;
+
+    /**
+     * Moves the cursor of a writer past what was just written
+     * @param written Number of bytes that were written
+    */
+    void Advance(uint64_t written)
+    {
+        mCursor += written;
+
+        if (mDurability.Level < BgeDurability::PERIODIC)
+            return;
+
+        mUnsynced += written;
+        if (SyncDue())
+            Sync();
+    }
+
+    /**
+     * @returns `true` if a periodic writer reached one of its limits since the last sync, otherwise `false`
+    */
+    bool SyncDue()
+    {
+        if (mDurability.Bytes != 0 && mUnsynced >= mDurability.Bytes)
+            return true;
+
+        if (mDurability.Milliseconds == 0 || mUnsynced == 0)
+            return false;
+
+        return std::chrono::steady_clock::now() - mLastSync >= std::chrono::milliseconds(mDurability.Milliseconds);
+    }
+
+    /**
+     * Gives the file a sequential access hint once enough of it was read front to back
+     * @param length Number of bytes about to be read at the cursor
+    */
+    void TrackSequential(uint64_t length)
+    {
+        if (BGE_FILE_SEQUENTIAL_HINT == 0 || mSequentialAdvised)
+            return;
+
+        if (mCursor != mSequentialEnd)
+            mSequentialLength = 0;
+
+        mSequentialEnd = mCursor + length;
+        mSequentialLength += length;
+
+        // hinting before the read lets a single big read profit as well
+        if (mSequentialLength >= BGE_FILE_SEQUENTIAL_HINT)
+        {
+            mBackend->Advise(BgeIoAdvice::SEQUENTIAL, 0, 0);
+            mSequentialAdvised = true;
+        }
+    }
+
+    /**
+     * Creates the temporary file of an atomic writer in the directory of the target
+     * @returns `true` if the temporary file was opened by the backend, otherwise `false`
+    */
+    bool OpenTemporary()
+    {
+#ifdef _WIN32
+        mTempPath = mPath + ".tmp";
+#else
+        std::string tempPath = mPath + ".XXXXXX";
+        int descriptor = mkstemp(&tempPath[0]);
+        if (descriptor < 0)
+            return false;
+
+        // keep the permissions of the file we are about to replace, new files get the ones
+        // they would have gotten from a plain open, mkstemp itself only grants 0600
+        struct stat targetStat;
+        mode_t mode;
+        if (stat(mPath.c_str(), &targetStat) == 0)
+            mode = targetStat.st_mode & 07777;
+        else
+        {
+            mode_t mask = umask(0);
+            umask(mask);
+            mode = 0666 & ~mask;
+        }
+
+        if (fchmod(descriptor, mode) != 0)
+        {
+            BGE_LOG("Could not set the permissions of temporary file \"%s\"\n", tempPath.c_str());
+            close(descriptor);
+            remove(tempPath.c_str());
+            return false;
+        }
+        close(descriptor);
+
+        // the name is ours now, the backend just empties the file again
+        mTempPath = tempPath;
+#endif
+
+        if (mBackend->Open(mTempPath, BgeIoMode::WRITE))
+            return true;
+
+        remove(mTempPath.c_str());
+        mTempPath.clear();
+        return false;
+    }
+
+    /**
+     * Flushes the temporary file of an atomic writer to the disk and renames it over the target
+     * @returns `true` if the target file was replaced, otherwise `false`
+    */
+    bool CommitTemporary()
+    {
+        bool synced = mBackend->Sync();
+        synced = mBackend->Close() && synced;
+#ifdef _WIN32
+        bool renamed = synced && MoveFileExA(mTempPath.c_str(), mPath.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH);
+#else
+        bool renamed = synced && rename(mTempPath.c_str(), mPath.c_str()) == 0;
+
+        // the rename itself only survives a crash once the directory is on the disk too
+        if (renamed)
+        {
+            size_t nameDivider = mPath.find_last_of('/');
+            std::string directory = (nameDivider == std::string::npos) ? "." : mPath.substr(0, nameDivider + 1);
+            int directoryDescriptor = open(directory.c_str(), O_RDONLY);
+            if (directoryDescriptor >= 0)
+            {
+                fsync(directoryDescriptor);
+                close(directoryDescriptor);
+            }
+        }
+#endif
+
+        if (!renamed)
+        {
+            BGE_LOG("Could not save file \"%s\": Replacing the file failed, it was left untouched\n", mPath.c_str());
+            remove(mTempPath.c_str());
+        }
+        mTempPath.clear();
+        return renamed;
+    }
+
+private:
+    /**
+     * @brief Backend that does the actual work
      */
-    FILE* mFileHandle;
+    std::unique_ptr<Backend> mBackend;
 
     /**
      * @brief Path to the file
@@ -413,6 +899,132 @@ private:
      * @brief Set to true if an attempt at reading fails due to reaching the end of the file
      */
     bool mEOF;
+
+    /**
+     * @brief Options this file was created with
+     */
+    BgeFileFlags mFlags;
+
+    /**
+     * @brief Path of the temporary file of an atomic writer, empty if there is none
+     */
+    std::string mTempPath;
+
+    /**
+     * @brief End of the last read, the next read continues the sequential run if it starts here
+     */
+    uint64_t mSequentialEnd;
+
+    /**
+     * @brief Number of bytes read front to back without jumping around
+     */
+    uint64_t mSequentialLength;
+
+    /**
+     * @brief Set to true once a hint was given, so the automatic one is only given once
+     */
+    bool mSequentialAdvised;
+
+    /**
+     * @brief When this writer syncs its data
+     */
+    BgeDurabilityPolicy mDurability;
+
+    /**
+     * @brief Number of bytes written since the last sync
+     */
+    uint64_t mUnsynced;
+
+    /**
+     * @brief Time of the last sync
+     */
+    std::chrono::steady_clock::time_point mLastSync;
+};
+
+/**
+ * A `BgeBasicFile` that picks its backend at runtime
+ * @note A struct instead of an alias, so `struct BgeFile;` still works as a forward declaration
+*/
+struct BgeFile : BgeBasicFile<>
+{
+    using BgeBasicFile<>::BgeBasicFile;
 };
 
+/**
+ * A `BgeFile` that reads from and writes into memory instead of a file on the disk
+ *
+ * @note Has the full `BgeFile` API, to read what was written `Reopen` the file. Only
+ *       `BgeFileFlags::APPEND` is supported, writers start with an empty buffer otherwise.
+*/
+struct BgeMemoryFile : BgeBasicFile<BgeMemoryBackend>
+{
+    /**
+     * Creates a new `BgeMemoryFile` with its own buffer
+     * @param write If the file should be read-write or read-only
+    */
+    BgeMemoryFile(bool write = false)
+        : BgeBasicFile<BgeMemoryBackend>("", write, BgeFileFlags::NONE, std::unique_ptr<BgeMemoryBackend>(new BgeMemoryBackend()))
+    {
+    }
+
+    /**
+     * Creates a new `BgeMemoryFile` over a growable buffer
+     * @param buffer The buffer, has to outlive this file
+     * @param write If the file should be read-write or read-only
+     * @param flags Additional options, see `BgeFileFlags`
+    */
+    BgeMemoryFile(std::vector<std::byte>& buffer, bool write = false, BgeFileFlags flags = BgeFileFlags::NONE)
+        : BgeBasicFile<BgeMemoryBackend>("", write, flags & BgeFileFlags::APPEND, std::unique_ptr<BgeMemoryBackend>(new BgeMemoryBackend(buffer)))
+    {
+    }
+
+    /**
+     * Creates a new `BgeMemoryFile` over a fixed-size memory region
+     * @note Writers can't write past the end of the region
+     * @param data Start of the region, has to outlive this file
+     * @param size Size of the region in bytes
+     * @param write If the file should be read-write or read-only
+     * @param flags Additional options, see `BgeFileFlags`
+    */
+    BgeMemoryFile(void* data, size_t size, bool write = false, BgeFileFlags flags = BgeFileFlags::NONE)
+        : BgeBasicFile<BgeMemoryBackend>("", write, flags & BgeFileFlags::APPEND, std::unique_ptr<BgeMemoryBackend>(new BgeMemoryBackend(data, size)))
+    {
+    }
+
+    /**
+     * @returns The data in memory, valid until the next write
+    */
+    const std::byte* Data()
+    {
+        return GetBackend().Data();
+    }
+};
+
+/**
+ * Copies a file, inside the kernel without passing the data through this process where possible
+ * @param from Path of the file to copy
+ * @param to Path of the copy, an existing file is replaced
+ * @param flags Additional options for writing the copy, see `BgeFileFlags`
+ * @returns `true` if the whole file was copied, otherwise `false`
+*/
+inline bool BgeCopyFile(std::string from, std::string to, BgeFileFlags flags = BgeFileFlags::NONE)
+{
+    BgeFile source = BgeFile(from, false);
+    if (!source.Ready())
+        return false;
+
+    BgeFile target = BgeFile(to, true, flags);
+    if (!target.Ready())
+        return false;
+
+    if (source.CopyTo(target) != source.Size())
+    {
+        BGE_LOG("Could not copy file \"%s\" to \"%s\": Not everything could be copied\n", from.c_str(), to.c_str());
+        target.Discard();
+        return false;
+    }
+
+    return target.Close();
+}
+
 #endif
@@ -0,0 +1,340 @@
+/**
+ * @file BgeFileWatcher.hpp
+ * @author GAMINGNOOBdev (https://github.com/GAMINGNOOBdev)
+ * @brief A somewhat nice and easy file change watcher utility in a single header for C++
+ * @note This header does depend on BgeConfig.hpp and only watches files on Linux (inotify)
+ * @version 1.0
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) GAMINGNOOBdev 2024
+ */
+
+#ifndef __BGEFILEWATCHER_HPP_
+#define __BGEFILEWATCHER_HPP_ 1
+
+#include <BgeConfig.hpp>
+#include <unordered_map>
+#include <functional>
+#include <stdint.h>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#   include <sys/inotify.h>
+#   include <stdlib.h>
+#   include <unistd.h>
+#   include <fcntl.h>
+#   include <poll.h>
+#endif
+
+/**
+ * Function that gets called once a watched file changed
+ * @param path Path of the changed file, as it was passed to `BgeFileWatcher::Watch`
+*/
+using BgeFileWatchCallback = std::function<void(std::string path)>;
+
+/**
+ * Watches files for changes and calls back once a burst of changes settled down
+ *
+ * @note The directories of the files are watched instead of the files themselves, so that
+ *       editors which save by renaming a temporary file over the original are noticed too.
+ *       Callbacks are only ever called from inside `Poll`, on the polling thread.
+*/
+struct BgeFileWatcher
+{
+    /**
+     * Creates a new `BgeFileWatcher`
+     * @param debounceMs Time in milliseconds a file has to stay untouched before its callback is called
+    */
+    BgeFileWatcher(uint32_t debounceMs = 50)
+        : mDebounce(std::chrono::milliseconds(debounceMs)), mHandle(-1)
+    {
+#ifdef __linux__
+        mHandle = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (mHandle < 0)
+            BGE_LOG("Could not create file watcher: inotify is unavailable\n");
+#endif
+    }
+
+    BgeFileWatcher(const BgeFileWatcher&) = delete;
+    BgeFileWatcher& operator=(const BgeFileWatcher&) = delete;
+
+    /**
+     * Destroy this `BgeFileWatcher`
+    */
+    ~BgeFileWatcher()
+    {
+#ifdef __linux__
+        if (mHandle >= 0)
+            close(mHandle);
+#endif
+    }
+
+    /**
+     * Watches a file for changes
+     *
+     * @param path File path
+     * @param callback Function that is called after the file changed
+     *
+     * @returns `true` if the file is now being watched, otherwise `false`
+    */
+    bool Watch(std::string path, BgeFileWatchCallback callback)
+    {
+#ifdef __linux__
+        if (mHandle < 0 || path.empty() || callback == nullptr)
+            return false;
+
+        size_t nameDivider = path.find_last_of('/');
+        std::string directory = (nameDivider == std::string::npos) ? "." : path.substr(0, nameDivider);
+        std::string name = (nameDivider == std::string::npos) ? path : path.substr(nameDivider+1);
+        if (directory.empty())
+            directory = "/";
+
+        // "cfg" and "./cfg" share one watch descriptor, so events are only matched by the real path
+        char* resolved = realpath(directory.c_str(), nullptr);
+        if (resolved == nullptr)
+        {
+            BGE_LOG("Could not watch file \"%s\": Directory not accessible\n", path.c_str());
+            return false;
+        }
+        directory = resolved;
+        free(resolved);
+
+        int descriptor = inotify_add_watch(mHandle, directory.c_str(), IN_CLOSE_WRITE | IN_MODIFY | IN_MOVED_TO | IN_CREATE);
+        if (descriptor < 0)
+        {
+            BGE_LOG("Could not watch file \"%s\": Directory not accessible\n", path.c_str());
+            return false;
+        }
+
+        mDirectories[descriptor] = directory;
+        mFiles[JoinPath(directory, name)] = WatchedFile{path, descriptor, callback, false, Clock::time_point()};
+        return true;
+#else
+        BGE_LOG("Could not watch file \"%s\": File watching is only supported on Linux\n", path.c_str());
+        return false;
+#endif
+    }
+
+    /**
+     * Watches the file of a configuration and reloads it after it changed
+     * @note `BgeConfig::Reload` only reparses the sections that changed
+     * @param config Configuration that was opened from a file
+     * @returns `true` if the file is now being watched, otherwise `false`
+    */
+    bool Watch(BgeConfig& config)
+    {
+        BgeConfig* target = &config;
+        return Watch(config.GetPath(), [target](std::string){ target->Reload(); });
+    }
+
+    /**
+     * Watches the file of a `BgeFile`
+     *
+     * @param file The file that should be watched
+     * @param callback Function that is called after the file changed, reopens the file if not set
+     *
+     * @note Writers need a callback, reopening one would truncate the file every time it is flushed
+     *
+     * @returns `true` if the file is now being watched, otherwise `false`
+    */
+    bool Watch(BgeFile& file, BgeFileWatchCallback callback = nullptr)
+    {
+        if (callback == nullptr)
+        {
+            if (file.IsWriter())
+            {
+                BGE_LOG("Could not watch file \"%s\": Writers can't be reopened on change\n", file.GetPath().c_str());
+                return false;
+            }
+
+            BgeFile* target = &file;
+            callback = [target](std::string){ target->Reopen(false); };
+        }
+
+        return Watch(file.GetPath(), callback);
+    }
+
+    /**
+     * Stops watching a file
+     * @param path File path, as it was passed to `Watch`
+    */
+    void Unwatch(std::string path)
+    {
+#ifdef __linux__
+        for (auto file = mFiles.begin(); file != mFiles.end(); file++)
+        {
+            if (file->second.Path != path)
+                continue;
+
+            int descriptor = file->second.Descriptor;
+            mFiles.erase(file);
+
+            for (auto& other : mFiles)
+                if (other.second.Descriptor == descriptor)
+                    return;
+
+            inotify_rm_watch(mHandle, descriptor);
+            mDirectories.erase(descriptor);
+            return;
+        }
+#endif
+    }
+
+    /**
+     * Collects file changes and calls the callbacks of every file that stopped changing
+     *
+     * @param timeoutMs Maximum time in milliseconds to wait for changes, `0` returns immediately
+     *
+     * @returns The number of callbacks that were called
+    */
+    size_t Poll(int timeoutMs = 0)
+    {
+#ifdef __linux__
+        if (mHandle < 0)
+            return 0;
+
+        Clock::time_point timeout = Clock::now() + std::chrono::milliseconds(timeoutMs);
+        size_t called = 0;
+
+        while (true)
+        {
+            ReadEvents();
+            called += CallSettled();
+
+            Clock::time_point now = Clock::now();
+            if (called != 0 || now >= timeout)
+                break;
+
+            // sleep until either something happens or the next pending file settles
+            Clock::time_point wakeup = timeout;
+            for (auto& file : mFiles)
+                if (file.second.Pending && file.second.Deadline < wakeup)
+                    wakeup = file.second.Deadline;
+
+            pollfd handle = { mHandle, POLLIN, 0 };
+            int waitMs = (int)std::chrono::duration_cast<std::chrono::milliseconds>(wakeup - now).count();
+            poll(&handle, 1, waitMs < 1 ? 1 : waitMs);
+        }
+
+        return called;
+#else
+        return 0;
+#endif
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * A file that is being watched
+    */
+    struct WatchedFile
+    {
+        // Path as given by the user
+        std::string Path;
+
+        // Watch descriptor of the parent directory
+        int Descriptor;
+
+        // Callback after the file changed
+        BgeFileWatchCallback Callback;
+
+        // Set if the file changed and the callback wasn't called yet
+        bool Pending;
+
+        // Point in time after which the callback may be called
+        Clock::time_point Deadline;
+    };
+
+#ifdef __linux__
+    /**
+     * Reads all queued inotify events and marks the affected files as pending
+    */
+    void ReadEvents()
+    {
+        alignas(inotify_event) char buffer[4096];
+
+        while (true)
+        {
+            ssize_t length = read(mHandle, buffer, sizeof(buffer));
+            if (length <= 0)
+                return;
+
+            Clock::time_point deadline = Clock::now() + mDebounce;
+
+            for (char* cursor = buffer; cursor < buffer + length;)
+            {
+                inotify_event* event = (inotify_event*)cursor;
+                cursor += sizeof(inotify_event) + event->len;
+
+                // we lost events, so anything could have changed
+                if (event->mask & IN_Q_OVERFLOW)
+                {
+                    for (auto& file : mFiles)
+                        MarkPending(file.second, deadline);
+                    continue;
+                }
+
+                auto directory = mDirectories.find(event->wd);
+                if (directory == mDirectories.end() || event->len == 0)
+                    continue;
+
+                auto file = mFiles.find(JoinPath(directory->second, event->name));
+                if (file != mFiles.end())
+                    MarkPending(file->second, deadline);
+            }
+        }
+    }
+
+    static std::string JoinPath(const std::string& directory, const std::string& name)
+    {
+        // the root directory already ends with a slash
+        if (!directory.empty() && directory.back() == '/')
+            return directory + name;
+        return directory + "/" + name;
+    }
+
+    void MarkPending(WatchedFile& file, Clock::time_point deadline)
+    {
+        file.Pending = true;
+        file.Deadline = deadline;
+    }
+
+    /**
+     * Calls the callback of every pending file whose debounce time passed
+     * @returns The number of callbacks that were called
+    */
+    size_t CallSettled()
+    {
+        Clock::time_point now = Clock::now();
+        std::vector<WatchedFile*> settled;
+
+        for (auto& file : mFiles)
+            if (file.second.Pending && file.second.Deadline <= now)
+                settled.push_back(&file.second);
+
+        // callbacks may watch or unwatch files, so we copy everything we need beforehand
+        std::vector<std::pair<BgeFileWatchCallback, std::string>> calls;
+        for (auto file : settled)
+        {
+            file->Pending = false;
+            calls.emplace_back(file->Callback, file->Path);
+        }
+
+        for (auto& call : calls)
+            call.first(call.second);
+
+        return calls.size();
+    }
+#endif
+
+private:
+    std::unordered_map<std::string, WatchedFile> mFiles;
+    std::unordered_map<int, std::string> mDirectories;
+    Clock::duration mDebounce;
+    int mHandle;
+};
+
+#endif
@@ -0,0 +1,2327 @@
+/**
+ * @file BgeIoBackend.hpp
+ * @author GAMINGNOOBdev (https://github.com/GAMINGNOOBdev)
+ * @brief Exchangeable ways of how a `BgeFile` talks to the operating system, in a single header for C++
+ * @note This header is included by BgeFile.hpp, the POSIX and mmap backends are not available on Windows
+ * @version 1.0
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) GAMINGNOOBdev 2024
+ */
+
+#ifndef __BGEIOBACKEND_HPP_
+#define __BGEIOBACKEND_HPP_ 1
+
+#ifdef _WIN32
+#   pragma warning(disable: 4996)
+#endif
+
+#include <algorithm>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <condition_variable>
+#include <chrono>
+#include <cstddef>
+#include <deque>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <mutex>
+
+#ifdef _WIN32
+#   include <io.h>
+#   include <malloc.h>
+#else
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <unistd.h>
+#   include <fcntl.h>
+#endif
+
+#ifdef __linux__
+#   include <sys/sendfile.h>
+#endif
+
+// 64-bit file offsets, even where `long` and `off_t` are only 32 bits wide
+#if defined(_WIN32)
+#   define BGE_FOPEN fopen
+#   define BGE_FSEEK _fseeki64
+#   define BGE_FTELL _ftelli64
+#elif defined(__GLIBC__) && !defined(__LP64__) && defined(_LARGEFILE64_SOURCE)
+#   define BGE_FOPEN fopen64
+#   define BGE_FSEEK fseeko64
+#   define BGE_FTELL ftello64
+#   define BGE_OPEN open64
+#   define BGE_PREAD pread64
+#   define BGE_PWRITE pwrite64
+#   define BGE_FTRUNCATE ftruncate64
+#   define BGE_FSTAT fstat64
+#   define BGE_STAT stat64
+#   define BGE_MMAP mmap64
+#   define BGE_FALLOCATE fallocate64
+#   define BGE_POSIX_FALLOCATE posix_fallocate64
+#   define BGE_SENDFILE sendfile64
+#   define BGE_LSEEK lseek64
+#else
+#   define BGE_FOPEN fopen
+#   define BGE_FSEEK fseeko
+#   define BGE_FTELL ftello
+#   define BGE_OPEN open
+#   define BGE_PREAD pread
+#   define BGE_PWRITE pwrite
+#   define BGE_FTRUNCATE ftruncate
+#   define BGE_FSTAT fstat
+#   define BGE_STAT stat
+#   define BGE_MMAP mmap
+#   define BGE_FALLOCATE fallocate
+#   define BGE_POSIX_FALLOCATE posix_fallocate
+#   define BGE_SENDFILE sendfile
+#   define BGE_LSEEK lseek
+#endif
+
+#if !defined(_WIN32) && !defined(O_LARGEFILE)
+#   define O_LARGEFILE 0
+#endif
+
+// Alignment of offsets, sizes and buffers of unbuffered reads and writes
+#ifndef BGE_DIRECT_ALIGNMENT
+#   define BGE_DIRECT_ALIGNMENT 4096
+#endif
+
+// Size of the buffers of a `BgeAlignedBufferPool`, has to be a multiple of `BGE_DIRECT_ALIGNMENT`
+#ifndef BGE_DIRECT_BUFFER_SIZE
+#   define BGE_DIRECT_BUFFER_SIZE (1024 * 1024)
+#endif
+
+// Smallest and biggest amount a `BgeReadAheadBackend` reads ahead, it grows while the stream continues
+#ifndef BGE_READ_AHEAD_MIN
+#   define BGE_READ_AHEAD_MIN (64 * 1024)
+#endif
+
+#ifndef BGE_READ_AHEAD_MAX
+#   define BGE_READ_AHEAD_MAX (4 * 1024 * 1024)
+#endif
+
+// Size and number of the buffers of a `BgeWriteBehindBackend`, together they are all the memory it may use
+#ifndef BGE_WRITE_BEHIND_BUFFER_SIZE
+#   define BGE_WRITE_BEHIND_BUFFER_SIZE (256 * 1024)
+#endif
+
+#ifndef BGE_WRITE_BEHIND_BUFFER_COUNT
+#   define BGE_WRITE_BEHIND_BUFFER_COUNT 8
+#endif
+
+/**
+ * How a backend opens a file
+*/
+enum class BgeIoMode : uint8_t
+{
+    // Read only, the file has to exist
+    READ,
+
+    // Read-write, the file is created or emptied
+    WRITE,
+
+    // Write only, the file is created and its contents are kept
+    APPEND,
+};
+
+/**
+ * How a range of a file is going to be accessed, lets the operating system plan its caching
+*/
+enum class BgeIoAdvice : uint8_t
+{
+    // No special treatment, undoes the other hints
+    NORMAL,
+
+    // Read front to back, so reading ahead further pays off
+    SEQUENTIAL,
+
+    // Read in no particular order, reading ahead only wastes the page cache
+    RANDOM,
+
+    // Needed soon, starts reading it into the page cache in the background
+    WILLNEED,
+
+    // Not needed anymore, its pages can leave the page cache
+    DONTNEED,
+};
+
+/**
+ * Everything a `BgeFile` needs from the operating system
+ *
+ * @note Reads and writes are positional, the cursor is kept by the `BgeFile` itself.
+ *       Every implementation in this header is `final`, so a `BgeBasicFile` that is
+ *       instantiated with one of them directly calls it without any virtual call.
+*/
+struct BgeIoBackend
+{
+    virtual ~BgeIoBackend() = default;
+
+    /**
+     * Opens a file
+     * @param path File path
+     * @param mode How the file is opened
+     * @returns `true` if the file was opened, otherwise `false`
+    */
+    virtual bool Open(const std::string& path, BgeIoMode mode) = 0;
+
+    /**
+     * Closes the file, does nothing if no file is open
+     * @returns `true` if everything that was written reached the operating system, otherwise `false`
+    */
+    virtual bool Close() = 0;
+
+    /**
+     * Reads from a position of the file
+     * @param dst Destination buffer
+     * @param size Number of bytes to read
+     * @param offset Position in the file
+     * @returns Number of bytes that were read
+    */
+    virtual size_t Read(void* dst, size_t size, uint64_t offset) = 0;
+
+    /**
+     * Writes to a position of the file
+     * @note In `APPEND` mode everything is written at the end of the file
+     * @param src Source buffer
+     * @param size Number of bytes to write
+     * @param offset Position in the file
+     * @returns Number of bytes that were written
+    */
+    virtual size_t Write(const void* src, size_t size, uint64_t offset) = 0;
+
+    /**
+     * @returns The size of the file in bytes
+    */
+    virtual uint64_t Size() = 0;
+
+    /**
+     * Hands everything written so far over to the operating system
+    */
+    virtual bool Flush() = 0;
+
+    /**
+     * Waits until everything written so far reached the disk
+    */
+    virtual bool Sync() = 0;
+
+    /**
+     * Tells the operating system how a range of the file is going to be accessed
+     * @note Only a hint, reading and writing works the same no matter if it was applied
+     * @param advice How the range is accessed
+     * @param offset Start of the range
+     * @param length Length of the range, `0` reaches to the end of the file
+     * @returns `true` if the hint was applied, otherwise `false`
+    */
+    virtual bool Advise(BgeIoAdvice advice, uint64_t offset, uint64_t length) = 0;
+
+    /**
+     * Allocates the disk space for the file to grow to `size` bytes up front
+     * @note Where the space can only be allocated by growing the file, it grows right away and
+     *       is cut back to its real size on `Close`, appending writers are left alone then
+     * @param size Size of the file in bytes the space is allocated for
+     * @param trim If space that wasn't written to is given back on `Close`
+     * @returns `true` if the space was allocated, otherwise `false`
+    */
+    virtual bool Reserve(uint64_t size, bool trim) = 0;
+
+    /**
+     * Hands out the file descriptor, so the kernel can copy from and into the file directly
+     * @note Everything written so far is handed to the operating system first
+     * @returns The file descriptor, `-1` if there is none
+    */
+    virtual int Descriptor() = 0;
+
+    /**
+     * Tells the backend that a range of its file was written through `Descriptor`
+     * @param offset Start of the range
+     * @param length Length of the range
+    */
+    virtual void Changed(uint64_t offset, uint64_t length) = 0;
+};
+
+/**
+ * A pool of `BGE_DIRECT_BUFFER_SIZE` byte buffers that are aligned to `BGE_DIRECT_ALIGNMENT`
+ *
+ * @note Released buffers are kept for the next `Acquire`, up to a limit, so streaming many
+ *       files one after another doesn't allocate over and over again. Thread-safe.
+*/
+struct BgeAlignedBufferPool
+{
+    /**
+     * Creates a new empty pool
+     * @param maxFree Number of released buffers that are kept for reuse
+    */
+    BgeAlignedBufferPool(size_t maxFree = 16)
+        : mMutex(), mFree(), mMaxFree(maxFree)
+    {
+    }
+
+    BgeAlignedBufferPool(const BgeAlignedBufferPool&) = delete;
+    BgeAlignedBufferPool& operator=(const BgeAlignedBufferPool&) = delete;
+
+    ~BgeAlignedBufferPool()
+    {
+        for (void* buffer : mFree)
+            FreeBuffer(buffer);
+    }
+
+    /**
+     * @returns A buffer of `BGE_DIRECT_BUFFER_SIZE` bytes, `nullptr` if there is no memory left
+    */
+    void* Acquire()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            if (!mFree.empty())
+            {
+                void* buffer = mFree.back();
+                mFree.pop_back();
+                return buffer;
+            }
+        }
+
+#ifdef _WIN32
+        return _aligned_malloc(BGE_DIRECT_BUFFER_SIZE, BGE_DIRECT_ALIGNMENT);
+#else
+        void* buffer = nullptr;
+        if (posix_memalign(&buffer, BGE_DIRECT_ALIGNMENT, BGE_DIRECT_BUFFER_SIZE) != 0)
+            return nullptr;
+
+        return buffer;
+#endif
+    }
+
+    /**
+     * Gives a buffer back to the pool
+     * @param buffer A buffer from `Acquire`, `nullptr` is ignored
+    */
+    void Release(void* buffer)
+    {
+        if (buffer == nullptr)
+            return;
+
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (mFree.size() < mMaxFree)
+            mFree.push_back(buffer);
+        else
+            FreeBuffer(buffer);
+    }
+
+    /**
+     * @returns The pool that is used if no other one is given
+    */
+    static BgeAlignedBufferPool& Shared()
+    {
+        static BgeAlignedBufferPool pool;
+        return pool;
+    }
+
+private:
+    static void FreeBuffer(void* buffer)
+    {
+#ifdef _WIN32
+        _aligned_free(buffer);
+#else
+        free(buffer);
+#endif
+    }
+
+private:
+    std::mutex mMutex;
+    std::vector<void*> mFree;
+    size_t mMaxFree;
+};
+
+#if !defined(_WIN32) && defined(POSIX_FADV_NORMAL)
+/**
+ * Passes a hint to `posix_fadvise`
+*/
+inline bool BgeAdviseDescriptor(int descriptor, BgeIoAdvice advice, uint64_t offset, uint64_t length)
+{
+    const int advices[] = { POSIX_FADV_NORMAL, POSIX_FADV_SEQUENTIAL, POSIX_FADV_RANDOM, POSIX_FADV_WILLNEED, POSIX_FADV_DONTNEED };
+    return posix_fadvise(descriptor, offset, length, advices[(int)advice]) == 0;
+}
+#else
+inline bool BgeAdviseDescriptor(int, BgeIoAdvice, uint64_t, uint64_t)
+{
+    return false;
+}
+#endif
+
+#ifndef _WIN32
+/**
+ * Allocates the disk space for a file of `size` bytes with `fallocate` or `posix_fallocate`
+ * @param extend If the file may grow to `size` if the space can't be allocated otherwise
+ * @param[out] extended Set if the file grew, it has to be cut back to its real size later
+ * @returns `true` if the space was allocated, otherwise `false`
+*/
+inline bool BgeReserveDescriptor(int descriptor, uint64_t size, bool extend, bool& extended)
+{
+    extended = false;
+
+#if defined(__linux__) && defined(FALLOC_FL_KEEP_SIZE)
+    if (BGE_FALLOCATE(descriptor, FALLOC_FL_KEEP_SIZE, 0, size) == 0)
+        return true;
+#endif
+
+#ifdef __APPLE__
+    return false;
+#else
+    struct BGE_STAT fileStat;
+    if (BGE_FSTAT(descriptor, &fileStat) != 0)
+        return false;
+
+    // `posix_fallocate` grows files that are smaller
+    bool grows = (uint64_t)fileStat.st_size < size;
+    if (grows && !extend)
+        return false;
+
+    if (BGE_POSIX_FALLOCATE(descriptor, 0, size) != 0)
+        return false;
+
+    extended = grows;
+    return true;
+#endif
+}
+#endif
+
+/**
+ * Lets writers that sync the same file at the same time share their syncs
+ *
+ * @note Writers are told apart by the file they write to (device and inode), not by their backend,
+ *       so several `BgeFile`s writing one file share a sync as well. The first writer of a file that
+ *       calls `Commit` syncs everything committed for that file in the meantime, while the others
+ *       just wait for it, writers committing during that are synced together in the next round.
+ *       Writers of different files never wait on each other, their syncs run on their own threads.
+*/
+struct BgeGroupCommit
+{
+    /**
+     * Creates a new group
+     * @param delay Time the syncing writer waits for others to join before it starts
+    */
+    BgeGroupCommit(std::chrono::microseconds delay = std::chrono::microseconds(0))
+        : mMutex(), mDone(), mFiles(), mDelay(delay)
+    {
+    }
+
+    BgeGroupCommit(const BgeGroupCommit&) = delete;
+    BgeGroupCommit& operator=(const BgeGroupCommit&) = delete;
+
+    /**
+     * Waits until everything written to a backend so far reached the disk
+     * @param backend The backend, must not be used by anyone else until this returns
+     * @returns `true` if the data is on the disk, otherwise `false`
+    */
+    bool Commit(BgeIoBackend& backend)
+    {
+        // this also hands the written data to the operating system, so whoever syncs the file
+        // only has to sync once for everyone
+        FileId file = Identify(backend);
+        Request request = Request{&backend, false, false};
+
+        std::unique_lock<std::mutex> lock(mMutex);
+        FileQueue& queue = mFiles[file];
+        queue.Pending.push_back(&request);
+
+        while (!request.Done)
+        {
+            if (queue.Syncing)
+            {
+                mDone.wait(lock);
+                continue;
+            }
+
+            queue.Syncing = true;
+            if (mDelay.count() != 0)
+            {
+                lock.unlock();
+                std::this_thread::sleep_for(mDelay);
+                lock.lock();
+            }
+
+            std::vector<Request*> batch;
+            batch.swap(queue.Pending);
+            lock.unlock();
+            SyncBatch(batch);
+            lock.lock();
+
+            for (Request* pending : batch)
+                pending->Done = true;
+
+            queue.Syncing = false;
+            if (queue.Pending.empty())
+                mFiles.erase(file);
+
+            mDone.notify_all();
+        }
+        return request.Synced;
+    }
+
+    /**
+     * @returns The group that is used if no other one is given
+    */
+    static BgeGroupCommit& Shared()
+    {
+        static BgeGroupCommit group;
+        return group;
+    }
+
+private:
+    /**
+     * Device and inode of a file, backends without a descriptor are files of their own
+    */
+    using FileId = std::pair<uint64_t, uint64_t>;
+
+    /**
+     * A writer waiting for its data to reach the disk
+    */
+    struct Request
+    {
+        BgeIoBackend* Backend;
+        bool Done;
+        bool Synced;
+    };
+
+    /**
+     * The writers of one file
+    */
+    struct FileQueue
+    {
+        // Writers that wait for the next round
+        std::vector<Request*> Pending;
+
+        // Set while a writer syncs a round
+        bool Syncing = false;
+    };
+
+    static FileId Identify(BgeIoBackend& backend)
+    {
+#ifndef _WIN32
+        struct BGE_STAT fileStat;
+        int descriptor = backend.Descriptor();
+        if (descriptor >= 0 && BGE_FSTAT(descriptor, &fileStat) == 0)
+            return FileId((uint64_t)fileStat.st_dev, (uint64_t)fileStat.st_ino);
+#endif
+        return FileId(UINT64_MAX, (uint64_t)(uintptr_t)&backend);
+    }
+
+    /**
+     * Syncs the file of a batch once
+     * @note A sync covers the whole file, no matter through which descriptor the data was written
+    */
+    static void SyncBatch(std::vector<Request*>& batch)
+    {
+        BgeIoBackend* syncing = batch[0]->Backend;
+        for (Request* request : batch)
+            request->Synced = request->Backend == syncing || request->Backend->Flush();
+
+        bool synced = syncing->Sync();
+        for (Request* request : batch)
+            request->Synced = request->Synced && synced;
+    }
+
+private:
+    std::mutex mMutex;
+    std::condition_variable mDone;
+
+    // Writers that wait for their file to be synced, by file
+    std::map<FileId, FileQueue> mFiles;
+
+    std::chrono::microseconds mDelay;
+};
+
+/**
+ * Backend using the buffered `FILE*` functions of the C standard library
+*/
+struct BgeStdioBackend final : BgeIoBackend
+{
+    BgeStdioBackend()
+        : mHandle(nullptr), mPosition(0), mSize(0), mAppend(false), mTrim(false)
+    {
+    }
+
+    ~BgeStdioBackend()
+    {
+        Close();
+    }
+
+    bool Open(const std::string& path, BgeIoMode mode) override
+    {
+        Close();
+
+        const char* modes[] = { "rb", "wb+", "ab" };
+        mHandle = BGE_FOPEN(path.c_str(), modes[(int)mode]);
+        if (mHandle == nullptr)
+            return false;
+
+        BGE_FSEEK(mHandle, 0, SEEK_END);
+        mSize = BGE_FTELL(mHandle);
+        BGE_FSEEK(mHandle, 0, SEEK_SET);
+        mPosition = 0;
+        mAppend = mode == BgeIoMode::APPEND;
+        return true;
+    }
+
+    bool Close() override
+    {
+        if (mHandle == nullptr)
+            return true;
+
+        bool closed = true;
+#ifndef _WIN32
+        // reserved space that wasn't written to is given back
+        if (mTrim)
+            closed = fflush(mHandle) == 0 && BGE_FTRUNCATE(fileno(mHandle), mSize) == 0;
+#endif
+
+        closed = fclose(mHandle) == 0 && closed;
+        mHandle = nullptr;
+        mTrim = false;
+        return closed;
+    }
+
+    size_t Read(void* dst, size_t size, uint64_t offset) override
+    {
+        // sequential access doesn't need any seeking, which would throw away the stdio buffer
+        if (offset != mPosition)
+            BGE_FSEEK(mHandle, offset, SEEK_SET);
+
+        size_t count = fread(dst, 1, size, mHandle);
+        mPosition = offset + count;
+        return count;
+    }
+
+    size_t Write(const void* src, size_t size, uint64_t offset) override
+    {
+        if (offset != mPosition)
+            BGE_FSEEK(mHandle, offset, SEEK_SET);
+
+        size_t count = fwrite(src, 1, size, mHandle);
+        mPosition = offset + count;
+        mSize = std::max(mSize, mPosition);
+        return count;
+    }
+
+    uint64_t Size() override
+    {
+        return mSize;
+    }
+
+    bool Flush() override
+    {
+        return fflush(mHandle) == 0;
+    }
+
+    bool Sync() override
+    {
+        if (fflush(mHandle) != 0)
+            return false;
+
+#if defined(_WIN32)
+        return _commit(_fileno(mHandle)) == 0;
+#elif defined(__APPLE__)
+        return fsync(fileno(mHandle)) == 0;
+#else
+        return fdatasync(fileno(mHandle)) == 0;
+#endif
+    }
+
+    bool Advise(BgeIoAdvice advice, uint64_t offset, uint64_t length) override
+    {
+#ifdef _WIN32
+        return false;
+#else
+        return mHandle != nullptr && BgeAdviseDescriptor(fileno(mHandle), advice, offset, length);
+#endif
+    }
+
+    bool Reserve(uint64_t size, bool trim) override
+    {
+#ifdef _WIN32
+        return false;
+#else
+        if (mHandle == nullptr)
+            return false;
+
+        // appending writes land at the very end, so the file must not grow ahead of them
+        bool extended;
+        if (!BgeReserveDescriptor(fileno(mHandle), size, !mAppend, extended))
+            return false;
+
+        mTrim = mTrim || trim || extended;
+        return true;
+#endif
+    }
+
+    int Descriptor() override
+    {
+#ifdef _WIN32
+        return -1;
+#else
+        if (mHandle == nullptr || fflush(mHandle) != 0)
+            return -1;
+
+        // the descriptor may be moved around, so the next access has to seek again
+        mPosition = UINT64_MAX;
+        return fileno(mHandle);
+#endif
+    }
+
+    void Changed(uint64_t offset, uint64_t length) override
+    {
+        mPosition = UINT64_MAX;
+        mSize = std::max(mSize, offset + length);
+    }
+
+private:
+    FILE* mHandle;
+    uint64_t mPosition;
+    uint64_t mSize;
+    bool mAppend;
+
+    // Set if the file is cut to its real size on `Close`
+    bool mTrim;
+};
+
+#ifndef _WIN32
+/**
+ * Backend using unbuffered POSIX file descriptors with `pread`/`pwrite`
+ * @note Good for random access, every call is a system call so avoid many tiny reads
+*/
+struct BgePosixBackend final : BgeIoBackend
+{
+    BgePosixBackend()
+        : mDescriptor(-1), mSize(0), mAppend(false), mTrim(false)
+    {
+    }
+
+    ~BgePosixBackend()
+    {
+        Close();
+    }
+
+    bool Open(const std::string& path, BgeIoMode mode) override
+    {
+        Close();
+
+        const int flags[] = { O_RDONLY, O_RDWR | O_CREAT | O_TRUNC, O_WRONLY | O_CREAT | O_APPEND };
+        mDescriptor = BGE_OPEN(path.c_str(), flags[(int)mode] | O_CLOEXEC | O_LARGEFILE, 0644);
+        if (mDescriptor < 0)
+            return false;
+
+        struct BGE_STAT fileStat;
+        mSize = (BGE_FSTAT(mDescriptor, &fileStat) == 0) ? fileStat.st_size : 0;
+        mAppend = mode == BgeIoMode::APPEND;
+        return true;
+    }
+
+    bool Close() override
+    {
+        if (mDescriptor < 0)
+            return true;
+
+        // reserved space that wasn't written to is given back
+        bool closed = !mTrim || BGE_FTRUNCATE(mDescriptor, mSize) == 0;
+        closed = close(mDescriptor) == 0 && closed;
+        mDescriptor = -1;
+        mTrim = false;
+        return closed;
+    }
+
+    size_t Read(void* dst, size_t size, uint64_t offset) override
+    {
+        size_t count = 0;
+        while (count < size)
+        {
+            ssize_t result = BGE_PREAD(mDescriptor, (char*)dst + count, size - count, offset + count);
+            if (result <= 0)
+                break;
+
+            count += result;
+        }
+        return count;
+    }
+
+    size_t Write(const void* src, size_t size, uint64_t offset) override
+    {
+        size_t count = 0;
+        while (count < size)
+        {
+            ssize_t result = BGE_PWRITE(mDescriptor, (const char*)src + count, size - count, offset + count);
+            if (result <= 0)
+                break;
+
+            count += result;
+        }
+
+        mSize = std::max(mSize, offset + count);
+        return count;
+    }
+
+    uint64_t Size() override
+    {
+        return mSize;
+    }
+
+    bool Flush() override
+    {
+        return true;
+    }
+
+    bool Sync() override
+    {
+#ifdef __APPLE__
+        return fsync(mDescriptor) == 0;
+#else
+        return fdatasync(mDescriptor) == 0;
+#endif
+    }
+
+    bool Advise(BgeIoAdvice advice, uint64_t offset, uint64_t length) override
+    {
+        return mDescriptor >= 0 && BgeAdviseDescriptor(mDescriptor, advice, offset, length);
+    }
+
+    bool Reserve(uint64_t size, bool trim) override
+    {
+        if (mDescriptor < 0)
+            return false;
+
+        // appending writes land at the very end, so the file must not grow ahead of them
+        bool extended;
+        if (!BgeReserveDescriptor(mDescriptor, size, !mAppend, extended))
+            return false;
+
+        mTrim = mTrim || trim || extended;
+        return true;
+    }
+
+    int Descriptor() override
+    {
+        return mDescriptor;
+    }
+
+    void Changed(uint64_t offset, uint64_t length) override
+    {
+        mSize = std::max(mSize, offset + length);
+    }
+
+private:
+    int mDescriptor;
+    uint64_t mSize;
+    bool mAppend;
+
+    // Set if the file is cut to its real size on `Close`
+    bool mTrim;
+};
+
+/**
+ * Backend that bypasses the page cache with `O_DIRECT` (`F_NOCACHE` on macOS)
+ *
+ * @note Good for huge files that are streamed once, they neither pass through the page cache
+ *       nor push anything else out of it. The operating system only accepts whole aligned blocks,
+ *       so reads and writes of any size and offset go through buffers of a `BgeAlignedBufferPool`:
+ *       reads are served from the last block range that was read, writes are collected and written
+ *       once a buffer is full. Unaligned starts and ends of a write keep what is in the file already.
+ *       Aligned reads into aligned memory go straight to the caller without copying. File systems
+ *       without unbuffered I/O (e.g. tmpfs) still work, just through the page cache.
+*/
+struct BgeDirectBackend final : BgeIoBackend
+{
+    /**
+     * Creates a new backend
+     * @param pool Pool the buffers are taken from, has to outlive this backend
+    */
+    BgeDirectBackend(BgeAlignedBufferPool& pool = BgeAlignedBufferPool::Shared())
+        : mPool(&pool), mDescriptor(-1), mSize(0), mDiskSize(0), mMode(BgeIoMode::READ), mDirect(false), mTrim(false),
+          mStage(nullptr), mStageOffset(0), mStageLength(0), mStaged(false), mCache(nullptr), mCacheOffset(0), mCacheLength(0)
+    {
+    }
+
+    BgeDirectBackend(const BgeDirectBackend&) = delete;
+    BgeDirectBackend& operator=(const BgeDirectBackend&) = delete;
+
+    ~BgeDirectBackend()
+    {
+        Close();
+    }
+
+    bool Open(const std::string& path, BgeIoMode mode) override
+    {
+        Close();
+
+        // unaligned writes need to read the blocks around them, so even appending writers need read-write access
+        const int flags[] = { O_RDONLY, O_RDWR | O_CREAT | O_TRUNC, O_RDWR | O_CREAT };
+        int openFlags = flags[(int)mode] | O_CLOEXEC | O_LARGEFILE;
+
+#ifdef O_DIRECT
+        mDescriptor = BGE_OPEN(path.c_str(), openFlags | O_DIRECT, 0644);
+        mDirect = mDescriptor >= 0;
+#endif
+        if (mDescriptor < 0)
+            mDescriptor = BGE_OPEN(path.c_str(), openFlags, 0644);
+
+        if (mDescriptor < 0)
+            return false;
+
+#ifdef F_NOCACHE
+        mDirect = fcntl(mDescriptor, F_NOCACHE, 1) == 0;
+#endif
+
+        struct BGE_STAT fileStat;
+        mSize = mDiskSize = (BGE_FSTAT(mDescriptor, &fileStat) == 0) ? fileStat.st_size : 0;
+        mMode = mode;
+        return true;
+    }
+
+    bool Close() override
+    {
+        if (mDescriptor < 0)
+            return true;
+
+        bool closed = Flush();
+
+        // reserved space that wasn't written to is given back
+        if (mTrim)
+            closed = BGE_FTRUNCATE(mDescriptor, mSize) == 0 && closed;
+
+        closed = close(mDescriptor) == 0 && closed;
+        mDescriptor = -1;
+        mTrim = false;
+
+        mPool->Release(mStage);
+        mPool->Release(mCache);
+        mStage = mCache = nullptr;
+        mStageLength = mCacheLength = 0;
+        mStaged = false;
+        mSize = mDiskSize = 0;
+        return closed;
+    }
+
+    size_t Read(void* dst, size_t size, uint64_t offset) override
+    {
+        if (offset >= mSize)
+            return 0;
+
+        size = std::min<uint64_t>(size, mSize - offset);
+
+        // written data has to be in the file before it can be read back
+        if (mStaged && offset < mStageOffset + mStageLength && offset + size > mStageOffset && !FlushStage())
+            return 0;
+
+        size_t count = 0;
+        while (count < size)
+        {
+            uint64_t position = offset + count;
+            char* target = (char*)dst + count;
+
+            // big aligned reads don't need the buffer
+            size_t direct = (size - count) - (size - count) % BGE_DIRECT_ALIGNMENT;
+            if (position % BGE_DIRECT_ALIGNMENT == 0 && (uintptr_t)target % BGE_DIRECT_ALIGNMENT == 0 && direct >= BGE_DIRECT_BUFFER_SIZE)
+            {
+                size_t result = ReadBlocks(target, direct, position);
+                count += result;
+                if (result != direct)
+                    break;
+
+                continue;
+            }
+
+            if ((position < mCacheOffset || position >= mCacheOffset + mCacheLength) && !FillCache(position))
+                break;
+
+            size_t available = std::min<uint64_t>(mCacheOffset + mCacheLength - position, size - count);
+            memcpy(target, mCache + (position - mCacheOffset), available);
+            count += available;
+        }
+        return count;
+    }
+
+    size_t Write(const void* src, size_t size, uint64_t offset) override
+    {
+        if (mMode == BgeIoMode::READ || size == 0)
+            return 0;
+
+        if (mMode == BgeIoMode::APPEND)
+            offset = mSize;
+
+        // the read buffer might hold what is overwritten now
+        mCacheLength = 0;
+
+        size_t count = 0;
+        while (count < size)
+        {
+            uint64_t position = offset + count;
+
+            // continue the collected data as long as it stays in one piece and fits into the buffer
+            bool continues = mStaged && position >= mStageOffset && position <= mStageOffset + mStageLength &&
+                             position < mStageOffset + BGE_DIRECT_BUFFER_SIZE;
+            if (!continues && !StartStage(position))
+                break;
+
+            size_t stageOffset = position - mStageOffset;
+            size_t length = std::min<size_t>(size - count, BGE_DIRECT_BUFFER_SIZE - stageOffset);
+            memcpy(mStage + stageOffset, (const char*)src + count, length);
+            mStageLength = std::max(mStageLength, stageOffset + length);
+            count += length;
+        }
+
+        mSize = std::max(mSize, offset + count);
+        return count;
+    }
+
+    uint64_t Size() override
+    {
+        return mSize;
+    }
+
+    bool Flush() override
+    {
+        if (!FlushStage())
+            return false;
+
+        // whole blocks were written, the padding behind the real end must not stay in the file
+        if (mMode == BgeIoMode::READ || mDiskSize == mSize)
+            return true;
+
+        if (BGE_FTRUNCATE(mDescriptor, mSize) != 0)
+            return false;
+
+        mDiskSize = mSize;
+        return true;
+    }
+
+    bool Sync() override
+    {
+        if (!Flush())
+            return false;
+
+#ifdef __APPLE__
+        return fsync(mDescriptor) == 0;
+#else
+        // unbuffered writes skip the page cache, but not the metadata and the cache of the drive
+        return fdatasync(mDescriptor) == 0;
+#endif
+    }
+
+    bool Advise(BgeIoAdvice advice, uint64_t offset, uint64_t length) override
+    {
+        return mDescriptor >= 0 && BgeAdviseDescriptor(mDescriptor, advice, offset, length);
+    }
+
+    bool Reserve(uint64_t size, bool trim) override
+    {
+        if (mDescriptor < 0 || mMode == BgeIoMode::READ)
+            return false;
+
+        // writes never append on their own here, so growing the file is fine
+        bool extended;
+        if (!BgeReserveDescriptor(mDescriptor, size, true, extended))
+            return false;
+
+        if (extended)
+            mDiskSize = std::max(mDiskSize, size);
+
+        mTrim = mTrim || trim;
+        return true;
+    }
+
+    int Descriptor() override
+    {
+        if (mDescriptor < 0 || !FlushStage())
+            return -1;
+
+        return mDescriptor;
+    }
+
+    void Changed(uint64_t offset, uint64_t length) override
+    {
+        mCacheLength = 0;
+        mSize = std::max(mSize, offset + length);
+        mDiskSize = std::max(mDiskSize, offset + length);
+    }
+
+    /**
+     * @returns `true` if the page cache is bypassed, `false` if the file system doesn't support it
+    */
+    bool IsDirect()
+    {
+        return mDirect;
+    }
+
+private:
+    /**
+     * Reads whole blocks, only the end of the file may cut the last one short
+    */
+    size_t ReadBlocks(char* dst, size_t size, uint64_t offset)
+    {
+        size_t count = 0;
+        while (count < size)
+        {
+            ssize_t result = BGE_PREAD(mDescriptor, dst + count, size - count, offset + count);
+            if (result <= 0)
+                break;
+
+            count += result;
+        }
+        return count;
+    }
+
+    size_t WriteBlocks(const char* src, size_t size, uint64_t offset)
+    {
+        size_t count = 0;
+        while (count < size)
+        {
+            ssize_t result = BGE_PWRITE(mDescriptor, src + count, size - count, offset + count);
+            if (result <= 0)
+                break;
+
+            count += result;
+        }
+        return count;
+    }
+
+    /**
+     * Reads the blocks around `position` into the read buffer
+     * @returns `true` if `position` is in the read buffer now, otherwise `false`
+    */
+    bool FillCache(uint64_t position)
+    {
+        if (mCache == nullptr && (mCache = (char*)mPool->Acquire()) == nullptr)
+            return false;
+
+        mCacheOffset = position - position % BGE_DIRECT_ALIGNMENT;
+        mCacheLength = ReadBlocks(mCache, BGE_DIRECT_BUFFER_SIZE, mCacheOffset);
+        return position < mCacheOffset + mCacheLength;
+    }
+
+    /**
+     * Reads a single block into `dst`, the part behind the end of the file is zeroed
+    */
+    void LoadBlock(char* dst, uint64_t offset)
+    {
+        size_t count = (offset < mDiskSize) ? ReadBlocks(dst, BGE_DIRECT_ALIGNMENT, offset) : 0;
+        memset(dst + count, 0, BGE_DIRECT_ALIGNMENT - count);
+    }
+
+    /**
+     * Writes what was collected so far and starts collecting at `position`
+    */
+    bool StartStage(uint64_t position)
+    {
+        if (!FlushStage())
+            return false;
+
+        if (mStage == nullptr && (mStage = (char*)mPool->Acquire()) == nullptr)
+            return false;
+
+        mStageOffset = position - position % BGE_DIRECT_ALIGNMENT;
+        mStageLength = position - mStageOffset;
+        mStaged = true;
+
+        // the start of the first block keeps what is in the file already
+        if (mStageLength != 0)
+            LoadBlock(mStage, mStageOffset);
+
+        return true;
+    }
+
+    /**
+     * Writes the collected data as whole blocks
+    */
+    bool FlushStage()
+    {
+        if (!mStaged)
+            return true;
+
+        mStaged = false;
+        if (mStageLength == 0)
+            return true;
+
+        size_t length = mStageLength + (BGE_DIRECT_ALIGNMENT - mStageLength % BGE_DIRECT_ALIGNMENT) % BGE_DIRECT_ALIGNMENT;
+        uint64_t end = mStageOffset + mStageLength;
+
+        // the rest of the last block keeps what is in the file behind the collected data
+        if (length != mStageLength)
+        {
+            memset(mStage + mStageLength, 0, length - mStageLength);
+            if (end < mSize && (mCache != nullptr || (mCache = (char*)mPool->Acquire()) != nullptr))
+            {
+                size_t blockOffset = mStageLength - mStageLength % BGE_DIRECT_ALIGNMENT;
+                LoadBlock(mCache, mStageOffset + blockOffset);
+                memcpy(mStage + mStageLength, mCache + mStageLength % BGE_DIRECT_ALIGNMENT, length - mStageLength);
+                mCacheLength = 0;
+            }
+        }
+
+        bool written = WriteBlocks(mStage, length, mStageOffset) == length;
+        mDiskSize = std::max<uint64_t>(mDiskSize, mStageOffset + length);
+        return written;
+    }
+
+private:
+    BgeAlignedBufferPool* mPool;
+    int mDescriptor;
+
+    // Real size of the file and size of it on the disk including the padding of the last block
+    uint64_t mSize;
+    uint64_t mDiskSize;
+
+    BgeIoMode mMode;
+    bool mDirect;
+
+    // Set if the file is cut to its real size on `Close`
+    bool mTrim;
+
+    // Written data that is collected until a buffer is full, starts at a block boundary
+    char* mStage;
+    uint64_t mStageOffset;
+    size_t mStageLength;
+    bool mStaged;
+
+    // Blocks that were read last
+    char* mCache;
+    uint64_t mCacheOffset;
+    size_t mCacheLength;
+};
+
+/**
+ * Backend that maps the whole file into memory
+ *
+ * @note Reads are plain copies out of the page cache without any system call. Writers grow
+ *       the file in big steps while writing and cut it to its real size again on `Close`.
+*/
+struct BgeMmapBackend final : BgeIoBackend
+{
+    BgeMmapBackend()
+        : mDescriptor(-1), mData(nullptr), mMappedLength(0), mCapacity(0), mSize(0), mWriter(false)
+    {
+    }
+
+    ~BgeMmapBackend()
+    {
+        Close();
+    }
+
+    bool Open(const std::string& path, BgeIoMode mode) override
+    {
+        Close();
+
+        // writes go through the mapping, so even appending writers need read-write access
+        const int flags[] = { O_RDONLY, O_RDWR | O_CREAT | O_TRUNC, O_RDWR | O_CREAT };
+        mDescriptor = BGE_OPEN(path.c_str(), flags[(int)mode] | O_CLOEXEC | O_LARGEFILE, 0644);
+        if (mDescriptor < 0)
+            return false;
+
+        struct BGE_STAT fileStat;
+        mSize = (BGE_FSTAT(mDescriptor, &fileStat) == 0) ? fileStat.st_size : 0;
+        mCapacity = mSize;
+        mWriter = mode != BgeIoMode::READ;
+
+        if (mSize != 0 && !Map(mSize))
+        {
+            Close();
+            return false;
+        }
+        return true;
+    }
+
+    bool Close() override
+    {
+        if (mDescriptor < 0)
+            return true;
+
+        Unmap();
+
+        bool closed = true;
+        if (mWriter && mCapacity != mSize)
+            closed = BGE_FTRUNCATE(mDescriptor, mSize) == 0;
+
+        closed = close(mDescriptor) == 0 && closed;
+        mDescriptor = -1;
+        mCapacity = mSize = 0;
+        return closed;
+    }
+
+    size_t Read(void* dst, size_t size, uint64_t offset) override
+    {
+        if (offset >= mSize)
+            return 0;
+
+        size_t count = std::min<uint64_t>(size, mSize - offset);
+        memcpy(dst, mData + offset, count);
+        return count;
+    }
+
+    size_t Write(const void* src, size_t size, uint64_t offset) override
+    {
+        if (!mWriter || size == 0)
+            return 0;
+
+        if (offset + size > mCapacity && !Grow(offset + size))
+            return 0;
+
+        memcpy(mData + offset, src, size);
+        mSize = std::max(mSize, offset + size);
+        return size;
+    }
+
+    uint64_t Size() override
+    {
+        return mSize;
+    }
+
+    bool Flush() override
+    {
+        return true;
+    }
+
+    bool Sync() override
+    {
+        if (!mWriter)
+            return true;
+
+        if (mData != nullptr && msync(mData, mSize, MS_SYNC) != 0)
+            return false;
+
+        // the spare capacity must not end up in the file
+        if (mCapacity != mSize && BGE_FTRUNCATE(mDescriptor, mSize) != 0)
+            return false;
+
+        mCapacity = mSize;
+#ifdef __APPLE__
+        return fsync(mDescriptor) == 0;
+#else
+        return fdatasync(mDescriptor) == 0;
+#endif
+    }
+
+    bool Advise(BgeIoAdvice advice, uint64_t offset, uint64_t length) override
+    {
+        if (mData == nullptr || offset >= mMappedLength)
+            return false;
+
+        // `madvise` only takes whole pages
+        uint64_t pageSize = sysconf(_SC_PAGESIZE);
+        uint64_t begin = offset - offset % pageSize;
+        uint64_t end = (length == 0) ? mMappedLength : std::min(offset + length, mMappedLength);
+
+        const int advices[] = { MADV_NORMAL, MADV_SEQUENTIAL, MADV_RANDOM, MADV_WILLNEED, MADV_DONTNEED };
+        return madvise(mData + begin, end - begin, advices[(int)advice]) == 0;
+    }
+
+    bool Reserve(uint64_t size, bool) override
+    {
+        // the spare capacity is always cut off again on `Close`
+        if (!mWriter || (size > mCapacity && !Grow(size)))
+            return false;
+
+        // growing only makes a sparse file, the blocks themselves are allocated here
+        bool extended;
+        return BgeReserveDescriptor(mDescriptor, size, false, extended);
+    }
+
+    int Descriptor() override
+    {
+        return mDescriptor;
+    }
+
+    void Changed(uint64_t offset, uint64_t length) override
+    {
+        uint64_t end = offset + length;
+        mSize = std::max(mSize, end);
+        mCapacity = std::max(mCapacity, end);
+
+        // the file grew behind the mapping, which has to cover it again
+        if (end > mMappedLength)
+        {
+            Unmap();
+            Map(mCapacity);
+        }
+    }
+
+    /**
+     * @returns The mapped contents of the file, `nullptr` if the file is empty
+    */
+    const char* Data()
+    {
+        return mData;
+    }
+
+private:
+    bool Map(uint64_t length)
+    {
+        int protection = mWriter ? (PROT_READ | PROT_WRITE) : PROT_READ;
+        // a 32-bit address space can't map every file
+        if (length > SIZE_MAX)
+            return false;
+
+        void* data = BGE_MMAP(nullptr, length, protection, MAP_SHARED, mDescriptor, 0);
+        if (data == MAP_FAILED)
+            return false;
+
+        mData = (char*)data;
+        mMappedLength = length;
+        return true;
+    }
+
+    void Unmap()
+    {
+        if (mData != nullptr)
+            munmap(mData, mMappedLength);
+
+        mData = nullptr;
+        mMappedLength = 0;
+    }
+
+    /**
+     * Makes the file and the mapping big enough for at least `end` bytes
+    */
+    bool Grow(uint64_t end)
+    {
+        uint64_t capacity = std::max<uint64_t>({ end, mCapacity * 2, 64 * 1024 });
+        if (BGE_FTRUNCATE(mDescriptor, capacity) != 0)
+            return false;
+
+        mCapacity = capacity;
+        if (capacity <= mMappedLength)
+            return true;
+
+        Unmap();
+        return Map(capacity);
+    }
+
+private:
+    int mDescriptor;
+    char* mData;
+    uint64_t mMappedLength;
+    uint64_t mCapacity;
+    uint64_t mSize;
+    bool mWriter;
+};
+#endif
+
+/**
+ * Backend that keeps the whole file in memory
+ *
+ * @note With a path, the file is read completely on `Open` and writers write it back in one
+ *       go on `Sync` and `Close`, good for small files that are read or written in many tiny
+ *       steps. With an empty path, or with a buffer of the caller, the data never leaves memory.
+*/
+struct BgeMemoryBackend final : BgeIoBackend
+{
+    /**
+     * Creates a backend with its own buffer
+    */
+    BgeMemoryBackend()
+        : mBuffer(), mTarget(&mBuffer), mSpan(nullptr), mSpanLength(0), mSpanCapacity(0), mPath(), mMode(BgeIoMode::READ),
+          mDirty(false), mOpen(false)
+    {
+    }
+
+    /**
+     * Creates a backend that reads from and writes into a growable buffer of the caller
+     * @param buffer The buffer, has to outlive this backend
+    */
+    BgeMemoryBackend(std::vector<std::byte>& buffer)
+        : mBuffer(), mTarget(&buffer), mSpan(nullptr), mSpanLength(0), mSpanCapacity(0), mPath(), mMode(BgeIoMode::READ),
+          mDirty(false), mOpen(false)
+    {
+    }
+
+    /**
+     * Creates a backend that reads from and writes into a fixed-size memory region of the caller
+     * @note Writes past the end of the region are cut off
+     * @param data Start of the region, has to outlive this backend
+     * @param size Size of the region in bytes, everything of it is readable
+    */
+    BgeMemoryBackend(void* data, size_t size)
+        : mBuffer(), mTarget(nullptr), mSpan((std::byte*)data), mSpanLength(size), mSpanCapacity(size), mPath(),
+          mMode(BgeIoMode::READ), mDirty(false), mOpen(false)
+    {
+    }
+
+    BgeMemoryBackend(const BgeMemoryBackend&) = delete;
+    BgeMemoryBackend& operator=(const BgeMemoryBackend&) = delete;
+
+    ~BgeMemoryBackend()
+    {
+        Close();
+    }
+
+    bool Open(const std::string& path, BgeIoMode mode) override
+    {
+        Close();
+
+        mMode = mode;
+        mDirty = false;
+        mPath = (mTarget == &mBuffer) ? path : std::string();
+
+        if (mPath.empty())
+        {
+            // memory only, so only writers start over
+            if (mode == BgeIoMode::WRITE)
+                Resize(0);
+
+            mOpen = true;
+            return true;
+        }
+
+        mBuffer.clear();
+
+        BgeStdioBackend file;
+        if (mode != BgeIoMode::WRITE && file.Open(path, BgeIoMode::READ))
+        {
+            mBuffer.resize(file.Size());
+            bool read = file.Read(mBuffer.data(), mBuffer.size(), 0) == mBuffer.size();
+            file.Close();
+
+            if (!read)
+                return false;
+        }
+
+        // creates or empties the file right away, so it behaves like the other backends
+        if (!file.Open(path, mode))
+            return false;
+
+        mOpen = true;
+        return file.Close();
+    }
+
+    bool Close() override
+    {
+        if (!mOpen)
+            return true;
+
+        mOpen = false;
+        if (mPath.empty())
+            return true;
+
+        bool written = WriteBack(false);
+        mBuffer.clear();
+        mBuffer.shrink_to_fit();
+        return written;
+    }
+
+    size_t Read(void* dst, size_t size, uint64_t offset) override
+    {
+        if (offset >= Size())
+            return 0;
+
+        size_t count = std::min<uint64_t>(size, Size() - offset);
+        memcpy(dst, Data() + offset, count);
+        return count;
+    }
+
+    size_t Write(const void* src, size_t size, uint64_t offset) override
+    {
+        if (mMode == BgeIoMode::APPEND)
+            offset = Size();
+
+        if (offset + size > Size() && !Resize(offset + size))
+            return 0;
+
+        if (offset >= Size())
+            return 0;
+
+        size = std::min<uint64_t>(size, Size() - offset);
+        memcpy(Data() + offset, src, size);
+        mDirty = true;
+        return size;
+    }
+
+    uint64_t Size() override
+    {
+        return (mTarget != nullptr) ? mTarget->size() : mSpanLength;
+    }
+
+    bool Flush() override
+    {
+        return true;
+    }
+
+    bool Sync() override
+    {
+        return mPath.empty() || WriteBack(true);
+    }
+
+    bool Advise(BgeIoAdvice, uint64_t, uint64_t) override
+    {
+        // everything is in memory already
+        return true;
+    }
+
+    bool Reserve(uint64_t size, bool) override
+    {
+        if (mTarget == nullptr)
+            return size <= mSpanCapacity;
+
+        mTarget->reserve(size);
+        return true;
+    }
+
+    int Descriptor() override
+    {
+        // the file on the disk is only written back on `Sync` and `Close`
+        return -1;
+    }
+
+    void Changed(uint64_t, uint64_t) override
+    {
+    }
+
+    /**
+     * @returns The data in memory
+    */
+    std::byte* Data()
+    {
+        return (mTarget != nullptr) ? mTarget->data() : mSpan;
+    }
+
+private:
+    /**
+     * Changes the size of the data, memory regions of the caller only grow up to their capacity
+     * @returns `false` if nothing more fits into the memory region, otherwise `true`
+    */
+    bool Resize(uint64_t size)
+    {
+        if (mTarget != nullptr)
+        {
+            mTarget->resize(size);
+            return true;
+        }
+
+        if (mSpanLength == mSpanCapacity && size > mSpanCapacity)
+            return false;
+
+        mSpanLength = std::min(size, mSpanCapacity);
+        return true;
+    }
+
+    /**
+     * Replaces the contents of the file with the buffer if anything was written
+    */
+    bool WriteBack(bool sync)
+    {
+        if (!mDirty || mMode == BgeIoMode::READ)
+            return true;
+
+        BgeStdioBackend file;
+        if (!file.Open(mPath, BgeIoMode::WRITE))
+            return false;
+
+        file.Reserve(mBuffer.size(), true);
+        bool written = file.Write(mBuffer.data(), mBuffer.size(), 0) == mBuffer.size();
+        written = written && (!sync || file.Sync());
+        mDirty = !(file.Close() && written);
+        return !mDirty;
+    }
+
+private:
+    std::vector<std::byte> mBuffer;
+
+    // Buffer that is read and written, `nullptr` for memory regions of the caller
+    std::vector<std::byte>* mTarget;
+
+    std::byte* mSpan;
+    uint64_t mSpanLength;
+    uint64_t mSpanCapacity;
+
+    // File that is kept in memory, empty if the data never leaves memory
+    std::string mPath;
+    BgeIoMode mMode;
+    bool mDirty;
+    bool mOpen;
+};
+
+/**
+ * Backend that reads ahead on a background thread while the caller works through what was read before
+ *
+ * @note Wraps another backend and keeps two buffers: the caller reads out of the front one while
+ *       the thread fills the back one with what comes next, then the two swap. Prefetching starts
+ *       as soon as a read continues where the front buffer ends, so from the start of the file or
+ *       after a jump once the caller kept reading on. Every swap doubles the amount that is read
+ *       ahead, from `BGE_READ_AHEAD_MIN` up to `BGE_READ_AHEAD_MAX`, a jump starts over. Writers
+ *       are passed through as they are.
+*/
+struct BgeReadAheadBackend final : BgeIoBackend
+{
+    /**
+     * Creates a new backend
+     * @param backend Backend that does the actual reading, a stdio one if not set
+    */
+    BgeReadAheadBackend(std::unique_ptr<BgeIoBackend> backend = nullptr)
+        : mBackend(std::move(backend)), mMode(BgeIoMode::READ), mFront(), mBack(), mWindow(BGE_READ_AHEAD_MIN),
+          mWorker(), mMutex(), mWake(), mDone(), mRequested(false), mReady(false), mStop(false)
+    {
+        if (mBackend == nullptr)
+            mBackend = std::unique_ptr<BgeIoBackend>(new BgeStdioBackend());
+    }
+
+    BgeReadAheadBackend(const BgeReadAheadBackend&) = delete;
+    BgeReadAheadBackend& operator=(const BgeReadAheadBackend&) = delete;
+
+    ~BgeReadAheadBackend()
+    {
+        Drop();
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mStop = true;
+        }
+        mWake.notify_one();
+
+        if (mWorker.joinable())
+            mWorker.join();
+
+        Close();
+    }
+
+    bool Open(const std::string& path, BgeIoMode mode) override
+    {
+        Drop();
+        mMode = mode;
+        return mBackend->Open(path, mode);
+    }
+
+    bool Close() override
+    {
+        Drop();
+        return mBackend->Close();
+    }
+
+    size_t Read(void* dst, size_t size, uint64_t offset) override
+    {
+        if (mMode != BgeIoMode::READ)
+        {
+            Drop();
+            return mBackend->Read(dst, size, offset);
+        }
+
+        size_t count = 0;
+        while (count < size)
+        {
+            uint64_t position = offset + count;
+            uint64_t frontEnd = mFront.Offset + mFront.Length;
+
+            if (position >= mFront.Offset && position < frontEnd)
+            {
+                size_t length = std::min<uint64_t>(frontEnd - position, size - count);
+                memcpy((char*)dst + count, mFront.Data.data() + (position - mFront.Offset), length);
+                count += length;
+                continue;
+            }
+
+            // the stream goes on, so the next part should be prefetched already
+            if (position == frontEnd)
+            {
+                if (!Advance(position))
+                    break;
+
+                continue;
+            }
+
+            // a jump, read the new spot right away and only prefetch once the caller keeps reading from there
+            Drop();
+            mWindow = BGE_READ_AHEAD_MIN;
+            if (!Fill(mFront, position))
+                break;
+        }
+        return count;
+    }
+
+    size_t Write(const void* src, size_t size, uint64_t offset) override
+    {
+        Drop();
+        return mBackend->Write(src, size, offset);
+    }
+
+    uint64_t Size() override
+    {
+        return mBackend->Size();
+    }
+
+    bool Flush() override
+    {
+        WaitIdle();
+        return mBackend->Flush();
+    }
+
+    bool Sync() override
+    {
+        WaitIdle();
+        return mBackend->Sync();
+    }
+
+    bool Advise(BgeIoAdvice advice, uint64_t offset, uint64_t length) override
+    {
+        WaitIdle();
+        return mBackend->Advise(advice, offset, length);
+    }
+
+    bool Reserve(uint64_t size, bool trim) override
+    {
+        WaitIdle();
+        return mBackend->Reserve(size, trim);
+    }
+
+    int Descriptor() override
+    {
+        Drop();
+        return mBackend->Descriptor();
+    }
+
+    void Changed(uint64_t offset, uint64_t length) override
+    {
+        Drop();
+        mBackend->Changed(offset, length);
+    }
+
+    /**
+     * @returns The backend that does the actual reading
+    */
+    BgeIoBackend& GetBackend()
+    {
+        return *mBackend;
+    }
+
+private:
+    /**
+     * A part of the file in memory
+    */
+    struct Buffer
+    {
+        std::vector<char> Data;
+        uint64_t Offset = 0;
+        size_t Length = 0;
+    };
+
+    /**
+     * Makes the part starting at `position` the front buffer and prefetches the one after it
+     * @returns `false` if there is nothing left to read, otherwise `true`
+    */
+    bool Advance(uint64_t position)
+    {
+        bool prefetched;
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mDone.wait(lock, [this]{ return !mRequested; });
+            prefetched = mReady && mBack.Offset == position;
+            mReady = false;
+        }
+
+        if (prefetched)
+            std::swap(mFront, mBack);
+        else if (!Fill(mFront, position))
+            return false;
+
+        if (mFront.Length == 0)
+            return false;
+
+        mWindow = std::min<size_t>(mWindow * 2, BGE_READ_AHEAD_MAX);
+        Request(mFront.Offset + mFront.Length);
+        return true;
+    }
+
+    /**
+     * Reads `mWindow` bytes at `position` into a buffer on this thread
+     * @returns `false` if nothing could be read, otherwise `true`
+    */
+    bool Fill(Buffer& buffer, uint64_t position)
+    {
+        buffer.Data.resize(mWindow);
+        buffer.Offset = position;
+        buffer.Length = mBackend->Read(buffer.Data.data(), mWindow, position);
+        return buffer.Length != 0;
+    }
+
+    /**
+     * Lets the thread read `mWindow` bytes at `position` into the back buffer
+    */
+    void Request(uint64_t position)
+    {
+        if (position >= mBackend->Size())
+            return;
+
+        mBack.Data.resize(mWindow);
+        mBack.Offset = position;
+
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mRequested = true;
+        }
+
+        if (!mWorker.joinable())
+            mWorker = std::thread(&BgeReadAheadBackend::Work, this);
+        else
+            mWake.notify_one();
+    }
+
+    /**
+     * Waits until the thread doesn't use the wrapped backend anymore
+    */
+    void WaitIdle()
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        mDone.wait(lock, [this]{ return !mRequested; });
+    }
+
+    /**
+     * Throws away everything that was read ahead
+    */
+    void Drop()
+    {
+        WaitIdle();
+        mReady = false;
+        mFront.Offset = mFront.Length = 0;
+        mBack.Length = 0;
+    }
+
+    void Work()
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        while (true)
+        {
+            mWake.wait(lock, [this]{ return mStop || mRequested; });
+            if (mStop)
+                return;
+
+            // the back buffer belongs to this thread until the request is done
+            lock.unlock();
+            mBack.Length = mBackend->Read(mBack.Data.data(), mBack.Data.size(), mBack.Offset);
+            lock.lock();
+
+            mRequested = false;
+            mReady = true;
+            mDone.notify_all();
+        }
+    }
+
+private:
+    std::unique_ptr<BgeIoBackend> mBackend;
+    BgeIoMode mMode;
+
+    // The caller reads out of the front buffer while the thread fills the back one
+    Buffer mFront;
+    Buffer mBack;
+
+    // Number of bytes that are read ahead next
+    size_t mWindow;
+
+    std::thread mWorker;
+    std::mutex mMutex;
+    std::condition_variable mWake;
+    std::condition_variable mDone;
+
+    // Set while the thread fills the back buffer
+    bool mRequested;
+
+    // Set once the back buffer holds what was requested
+    bool mReady;
+
+    bool mStop;
+};
+
+/**
+ * Backend that writes on a background thread, so writing never waits for the disk
+ *
+ * @note Wraps another backend. `Write` only copies into a ring of buffers, a buffer is handed
+ *       to the thread once it is full or the next write doesn't continue it. The thread writes
+ *       the buffers in order. The ring never grows beyond its budget: once every buffer waits
+ *       for the thread, `Write` waits as well until one is free again. Failed writes only show
+ *       up later, every `Write` after them returns `0` and `Flush`, `Sync` and `Close` return
+ *       `false`. Reads wait until everything was written.
+*/
+struct BgeWriteBehindBackend final : BgeIoBackend
+{
+    /**
+     * Creates a new backend
+     * @param backend Backend that does the actual writing, a stdio one if not set
+     * @param bufferSize Size of each buffer in bytes
+     * @param bufferCount Number of buffers, at least 2 so writing and collecting can overlap
+    */
+    BgeWriteBehindBackend(std::unique_ptr<BgeIoBackend> backend = nullptr, size_t bufferSize = BGE_WRITE_BEHIND_BUFFER_SIZE,
+                          size_t bufferCount = BGE_WRITE_BEHIND_BUFFER_COUNT)
+        : mBackend(std::move(backend)), mMode(BgeIoMode::READ), mSize(0), mBufferSize(std::max<size_t>(bufferSize, 1)),
+          mBufferCount(std::max<size_t>(bufferCount, 2)), mBuffers(), mFree(), mQueue(), mCurrent(nullptr), mWorker(), mMutex(),
+          mWake(), mDone(), mWriting(false), mFailed(false), mStop(false)
+    {
+        if (mBackend == nullptr)
+            mBackend = std::unique_ptr<BgeIoBackend>(new BgeStdioBackend());
+    }
+
+    BgeWriteBehindBackend(const BgeWriteBehindBackend&) = delete;
+    BgeWriteBehindBackend& operator=(const BgeWriteBehindBackend&) = delete;
+
+    ~BgeWriteBehindBackend()
+    {
+        Drain();
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mStop = true;
+        }
+        mWake.notify_one();
+
+        if (mWorker.joinable())
+            mWorker.join();
+
+        Close();
+    }
+
+    bool Open(const std::string& path, BgeIoMode mode) override
+    {
+        Drain();
+        mFailed = false;
+        mMode = mode;
+
+        if (!mBackend->Open(path, mode))
+            return false;
+
+        mSize = mBackend->Size();
+        return true;
+    }
+
+    bool Close() override
+    {
+        bool written = Drain();
+        return mBackend->Close() && written;
+    }
+
+    size_t Read(void* dst, size_t size, uint64_t offset) override
+    {
+        Drain();
+        return mBackend->Read(dst, size, offset);
+    }
+
+    size_t Write(const void* src, size_t size, uint64_t offset) override
+    {
+        if (mMode == BgeIoMode::READ || mFailed)
+            return 0;
+
+        if (mMode == BgeIoMode::APPEND)
+            offset = mSize;
+
+        size_t count = 0;
+        while (count < size)
+        {
+            uint64_t position = offset + count;
+            if (mCurrent != nullptr && (position != mCurrent->Offset + mCurrent->Length || mCurrent->Length == mBufferSize))
+                Submit();
+
+            if (mCurrent == nullptr)
+            {
+                mCurrent = AcquireBuffer();
+                mCurrent->Offset = position;
+                mCurrent->Length = 0;
+            }
+
+            size_t length = std::min(size - count, mBufferSize - mCurrent->Length);
+            memcpy(mCurrent->Data.data() + mCurrent->Length, (const char*)src + count, length);
+            mCurrent->Length += length;
+            count += length;
+        }
+
+        mSize = std::max(mSize, offset + count);
+        return count;
+    }
+
+    uint64_t Size() override
+    {
+        return mSize;
+    }
+
+    bool Flush() override
+    {
+        bool written = Drain();
+        return mBackend->Flush() && written;
+    }
+
+    bool Sync() override
+    {
+        bool written = Drain();
+        return mBackend->Sync() && written;
+    }
+
+    bool Advise(BgeIoAdvice advice, uint64_t offset, uint64_t length) override
+    {
+        Drain();
+        return mBackend->Advise(advice, offset, length);
+    }
+
+    bool Reserve(uint64_t size, bool trim) override
+    {
+        Drain();
+        return mBackend->Reserve(size, trim);
+    }
+
+    int Descriptor() override
+    {
+        return Drain() ? mBackend->Descriptor() : -1;
+    }
+
+    void Changed(uint64_t offset, uint64_t length) override
+    {
+        mSize = std::max(mSize, offset + length);
+        mBackend->Changed(offset, length);
+    }
+
+    /**
+     * @returns The backend that does the actual writing
+    */
+    BgeIoBackend& GetBackend()
+    {
+        return *mBackend;
+    }
+
+private:
+    /**
+     * Data that is written in one piece
+    */
+    struct Buffer
+    {
+        std::vector<char> Data;
+        uint64_t Offset = 0;
+        size_t Length = 0;
+    };
+
+    /**
+     * @returns A free buffer, waits for the thread if the whole budget is in use
+    */
+    Buffer* AcquireBuffer()
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        if (mFree.empty() && mBuffers.size() < mBufferCount)
+        {
+            mBuffers.emplace_back(new Buffer());
+            mBuffers.back()->Data.resize(mBufferSize);
+            return mBuffers.back().get();
+        }
+
+        mDone.wait(lock, [this]{ return !mFree.empty(); });
+        Buffer* buffer = mFree.back();
+        mFree.pop_back();
+        return buffer;
+    }
+
+    /**
+     * Hands the current buffer to the thread
+    */
+    void Submit()
+    {
+        if (mCurrent == nullptr)
+            return;
+
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mQueue.push_back(mCurrent);
+        }
+        mCurrent = nullptr;
+
+        if (!mWorker.joinable())
+            mWorker = std::thread(&BgeWriteBehindBackend::Work, this);
+        else
+            mWake.notify_one();
+    }
+
+    /**
+     * Waits until everything that was written so far reached the wrapped backend
+     * @returns `false` if any write failed, otherwise `true`
+    */
+    bool Drain()
+    {
+        if (mCurrent != nullptr && mCurrent->Length == 0)
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mFree.push_back(mCurrent);
+            mCurrent = nullptr;
+        }
+        Submit();
+
+        std::unique_lock<std::mutex> lock(mMutex);
+        mDone.wait(lock, [this]{ return mQueue.empty() && !mWriting; });
+        return !mFailed;
+    }
+
+    void Work()
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        while (true)
+        {
+            mWake.wait(lock, [this]{ return mStop || !mQueue.empty(); });
+            if (mQueue.empty())
+                return;
+
+            Buffer* buffer = mQueue.front();
+            mQueue.pop_front();
+            mWriting = true;
+
+            // the wrapped backend belongs to this thread while it writes
+            lock.unlock();
+            bool written = mBackend->Write(buffer->Data.data(), buffer->Length, buffer->Offset) == buffer->Length;
+            lock.lock();
+
+            mFailed = mFailed || !written;
+            mWriting = false;
+            mFree.push_back(buffer);
+            mDone.notify_all();
+        }
+    }
+
+private:
+    std::unique_ptr<BgeIoBackend> mBackend;
+    BgeIoMode mMode;
+
+    // Size of the file including everything that still waits to be written
+    uint64_t mSize;
+
+    size_t mBufferSize;
+    size_t mBufferCount;
+    std::vector<std::unique_ptr<Buffer>> mBuffers;
+    std::vector<Buffer*> mFree;
+
+    // Buffers that wait for the thread, oldest first
+    std::deque<Buffer*> mQueue;
+
+    // Buffer that is filled by `Write` right now
+    Buffer* mCurrent;
+
+    std::thread mWorker;
+    std::mutex mMutex;
+    std::condition_variable mWake;
+    std::condition_variable mDone;
+
+    // Set while the thread writes a buffer
+    bool mWriting;
+
+    std::atomic<bool> mFailed;
+    bool mStop;
+};
+
+#ifdef __linux__
+/**
+ * Copies a range from one file descriptor into another inside the kernel
+ * @note Tries `copy_file_range` (which can share the blocks on file systems with reflinks),
+ *       then `sendfile` and then `splice` through a pipe, each one continues where the one
+ *       before gave up
+ * @returns Number of bytes that were copied
+*/
+inline uint64_t BgeCopyDescriptor(int source, uint64_t sourceOffset, int target, uint64_t targetOffset, uint64_t length)
+{
+    const uint64_t chunk = 1 << 30;
+    uint64_t copied = 0;
+
+#if defined(__GLIBC__) && __GLIBC_PREREQ(2, 27)
+    while (copied < length)
+    {
+        loff_t in = sourceOffset + copied;
+        loff_t out = targetOffset + copied;
+        ssize_t result = copy_file_range(source, &in, target, &out, std::min(length - copied, chunk), 0);
+        if (result <= 0)
+            break;
+
+        copied += result;
+    }
+#endif
+
+    // `sendfile` writes wherever the target descriptor currently is
+    if (copied < length && BGE_LSEEK(target, targetOffset + copied, SEEK_SET) >= 0)
+    {
+        while (copied < length)
+        {
+#if defined(__GLIBC__) && !defined(__LP64__) && defined(_LARGEFILE64_SOURCE)
+            off64_t in = sourceOffset + copied;
+#else
+            off_t in = sourceOffset + copied;
+#endif
+            ssize_t result = BGE_SENDFILE(target, source, &in, std::min(length - copied, chunk));
+            if (result <= 0)
+                break;
+
+            copied += result;
+        }
+    }
+
+    int pipes[2];
+    if (copied == length || pipe(pipes) != 0)
+        return copied;
+
+    while (copied < length)
+    {
+        loff_t in = sourceOffset + copied;
+        ssize_t result = splice(source, &in, pipes[1], nullptr, std::min<uint64_t>(length - copied, 1 << 20), SPLICE_F_MOVE);
+        if (result <= 0)
+            break;
+
+        // everything in the pipe has to reach the target before the next round
+        ssize_t moved = 0;
+        while (moved < result)
+        {
+            loff_t out = targetOffset + copied + moved;
+            ssize_t written = splice(pipes[0], nullptr, target, &out, result - moved, SPLICE_F_MOVE);
+            if (written <= 0)
+                break;
+
+            moved += written;
+        }
+
+        copied += moved;
+        if (moved != result)
+            break;
+    }
+
+    close(pipes[0]);
+    close(pipes[1]);
+    return copied;
+}
+#endif
+
+/**
+ * Copies a range from one backend into another
+ * @note Copies inside the kernel if both backends have a file descriptor and the platform
+ *       allows it (see `BgeCopyDescriptor`), everything else goes through a buffer
+ * @param source Backend that is read from
+ * @param sourceOffset Start of the range in the source
+ * @param target Backend that is written to
+ * @param targetOffset Where the range starts in the target
+ * @param length Length of the range
+ * @returns Number of bytes that were copied
+*/
+inline uint64_t BgeCopyRange(BgeIoBackend& source, uint64_t sourceOffset, BgeIoBackend& target, uint64_t targetOffset, uint64_t length)
+{
+    uint64_t copied = 0;
+
+#ifdef __linux__
+    int sourceDescriptor = source.Descriptor();
+    int targetDescriptor = target.Descriptor();
+    if (sourceDescriptor >= 0 && targetDescriptor >= 0 && sourceDescriptor != targetDescriptor)
+    {
+        copied = BgeCopyDescriptor(sourceDescriptor, sourceOffset, targetDescriptor, targetOffset, length);
+        if (copied != 0)
+            target.Changed(targetOffset, copied);
+    }
+#endif
+
+    std::vector<char> buffer;
+    while (copied < length)
+    {
+        buffer.resize(std::min<uint64_t>(length - copied, 1 << 20));
+        size_t count = source.Read(buffer.data(), buffer.size(), sourceOffset + copied);
+        if (count == 0)
+            break;
+
+        size_t written = target.Write(buffer.data(), count, targetOffset + copied);
+        copied += written;
+        if (written != count)
+            break;
+    }
+    return copied;
+}
+
+#endif